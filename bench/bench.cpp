@@ -0,0 +1,105 @@
+// End-to-end benchmarks for reading, generating and writing INI files.
+//
+//   mini_bench [filter] [--repeat N] [--scale F]
+//
+// Every corpus shape from corpus.h is written to a file in the working
+// directory and then read, generated, written lazily with a few changed and
+// added keys, and read and written back as a round trip. See runner.h for
+// the output format.
+
+#include <fstream>
+#include <string>
+#include "mini/ini.h"
+#include "corpus.h"
+#include "runner.h"
+
+namespace
+{
+	void writeContents(std::string const& filename, std::string const& contents)
+	{
+		std::ofstream fileWriteStream(filename, std::ios::out | std::ios::binary);
+		fileWriteStream.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+	}
+
+	// changes every 100th key, adds a key to every 10th section and adds a section
+	void modify(mINI::INIStructure& ini)
+	{
+		std::size_t index = 0;
+		std::size_t sectionIndex = 0;
+		for (auto const& it : ini)
+		{
+			auto& collection = ini[it.first];
+			for (auto const& it2 : collection)
+			{
+				if (index++ % 100 == 0)
+				{
+					collection[it2.first] = "changed";
+				}
+			}
+			if (sectionIndex++ % 10 == 0)
+			{
+				collection["added key"] = "added";
+			}
+		}
+		ini["added section"]["key"] = "value";
+	}
+
+	void benchShape(bench::Runner& runner, bench::Shape const& shape)
+	{
+		const auto corpus = bench::makeCorpus(shape, runner.getOptions().scale);
+		const std::string name = shape.name;
+		const std::string filename = "bench_" + name + ".ini";
+		const std::string outputFilename = "bench_" + name + ".out.ini";
+		const std::size_t bytes = corpus.contents.size();
+		writeContents(filename, corpus.contents);
+
+		mINI::INIStructure original;
+		mINI::INIFile(filename).read(original);
+
+		runner.run("read", name, bytes, corpus.entries, [&] {
+			mINI::INIFile file(filename);
+			file.cacheContents = false;
+			mINI::INIStructure ini;
+			file.read(ini);
+			bench::keep(ini.size());
+		});
+
+		std::string generated;
+		mINI::INIGenerator().generate(original, generated);
+		runner.run("generate", name, generated.size(), corpus.entries, [&] {
+			bench::keep(mINI::INIFile(outputFilename).generate(original));
+		});
+
+		mINI::INIStructure modified;
+		runner.run("write", name, bytes, corpus.entries, [&] {
+			writeContents(filename, corpus.contents);
+			modified = original;
+			modify(modified);
+		}, [&] {
+			bench::keep(mINI::INIFile(filename).write(modified));
+		});
+
+		runner.run("roundtrip", name, bytes, corpus.entries, [&] {
+			writeContents(filename, corpus.contents);
+		}, [&] {
+			mINI::INIFile file(filename);
+			mINI::INIStructure ini;
+			file.read(ini);
+			ini["section_0"]["key_0"] = "changed";
+			bench::keep(file.write(ini));
+		});
+
+		std::remove(filename.c_str());
+		std::remove(outputFilename.c_str());
+	}
+}
+
+int main(int argc, char** argv)
+{
+	bench::Runner runner("file", bench::parseOptions(argc, argv));
+	for (auto const& shape : bench::shapes)
+	{
+		benchShape(runner, shape);
+	}
+	return 0;
+}
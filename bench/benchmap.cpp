@@ -0,0 +1,209 @@
+// Micro-benchmarks for INIMap<std::string> and INIStructure operations.
+//
+//   mini_bench_map    [filter] [--repeat N] [--scale F]
+//   mini_bench_map_cs (built with MINI_CASE_SENSITIVE)
+//
+// Maps of 1 to 10M keys (10M times the scale at most) are filled with keys
+// that are already lowercase ("lower") or use mixed case and padding that
+// lookups have to normalize ("mixed"). Each benchmark runs up to 100000
+// operations; ns_entry is the time per operation. remove() moves the
+// entries after the removed key and updates the index of every key, so each
+// call is linear in the map size; map_remove runs fewer removals on large
+// maps to update at most maxReindexed indices in total.
+
+#include <string>
+#include <vector>
+#include "mini/ini.h"
+#include "runner.h"
+
+namespace
+{
+#ifdef MINI_CASE_SENSITIVE
+	const char* const suite = "map_cs";
+#else
+	const char* const suite = "map";
+#endif
+
+	const std::size_t maxOperations = 100000;
+	const std::size_t maxReindexed = 10000000;
+
+	std::vector<std::string> makeKeys(const char* prefix, bool mixed, std::size_t count)
+	{
+		std::vector<std::string> keys;
+		keys.reserve(count);
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			keys.push_back((mixed) ? "  " + std::string(prefix) + "_Key_" + std::to_string(i) + " " : std::string(prefix) + "_key_" + std::to_string(i));
+		}
+		return keys;
+	}
+
+	void benchMap(bench::Runner& runner, std::string const& corpus, std::size_t size, bool mixed)
+	{
+		using T_Map = mINI::INIMap<std::string>;
+		const auto keys = makeKeys("present", mixed, size);
+		const std::size_t operations = std::min(size, maxOperations);
+		const auto missing = makeKeys("missing", mixed, operations);
+		T_Map map;
+		for (auto const& key : keys)
+		{
+			map.set(key, "value");
+		}
+		// spread lookups over the whole map
+		const std::size_t stride = std::max<std::size_t>(1, size / operations);
+
+		runner.run("map_index_hit", corpus, 0, operations, [&] {
+			std::size_t total = 0;
+			for (std::size_t i = 0; i < operations; ++i)
+			{
+				total += map[keys[i * stride]].size();
+			}
+			bench::keep(total);
+		});
+		runner.run("map_get", corpus, 0, operations, [&] {
+			std::size_t total = 0;
+			for (std::size_t i = 0; i < operations; ++i)
+			{
+				total += map.get(keys[i * stride]).size();
+			}
+			bench::keep(total);
+		});
+		runner.run("map_has", corpus, 0, operations, [&] {
+			std::size_t total = 0;
+			for (std::size_t i = 0; i < operations; ++i)
+			{
+				total += map.has(keys[i * stride]) + map.has(missing[i]);
+			}
+			bench::keep(total);
+		});
+		runner.run("map_set", corpus, 0, operations, [&] {
+			for (std::size_t i = 0; i < operations; ++i)
+			{
+				map.set(keys[i * stride], "changed");
+			}
+		});
+		runner.run("map_iterate", corpus, 0, size, [&] {
+			std::size_t total = 0;
+			for (auto const& it : map)
+			{
+				total += it.second.size();
+			}
+			bench::keep(total);
+		});
+		// misses insert keys, so every run starts from a copy
+		T_Map scratch;
+		runner.run("map_index_miss", corpus, 0, operations, [&] {
+			scratch = map;
+		}, [&] {
+			for (auto const& key : missing)
+			{
+				scratch[key];
+			}
+		});
+		scratch.clear();
+		const std::size_t removals = std::max<std::size_t>(1, std::min(operations, maxReindexed / size));
+		runner.run("map_remove", corpus, 0, removals, [&] {
+			for (std::size_t i = 0; i < removals; ++i)
+			{
+				map.set(missing[i], "value");
+			}
+		}, [&] {
+			for (std::size_t i = 0; i < removals; ++i)
+			{
+				map.remove(missing[i]);
+			}
+		});
+	}
+
+	// the same number of keys, 100 to a section
+	void benchStructure(bench::Runner& runner, std::string const& corpus, std::size_t size, bool mixed)
+	{
+		const std::size_t keysPerSection = std::min<std::size_t>(size, 100);
+		const std::size_t sectionCount = size / keysPerSection;
+		const auto sections = makeKeys("section", mixed, sectionCount);
+		const auto keys = makeKeys("present", mixed, keysPerSection);
+		const std::size_t operations = std::min(size, maxOperations);
+		mINI::INIStructure ini;
+		for (auto const& section : sections)
+		{
+			auto& collection = ini[section];
+			for (auto const& key : keys)
+			{
+				collection.set(key, "value");
+			}
+		}
+		auto const& section = [&](std::size_t i) -> std::string const& { return sections[(i * 7919) % sectionCount]; };
+		auto const& key = [&](std::size_t i) -> std::string const& { return keys[i % keysPerSection]; };
+
+		runner.run("structure_index_hit", corpus, 0, operations, [&] {
+			std::size_t total = 0;
+			for (std::size_t i = 0; i < operations; ++i)
+			{
+				total += ini[section(i)][key(i)].size();
+			}
+			bench::keep(total);
+		});
+		// get() returns a copy of the whole section
+		runner.run("structure_get", corpus, 0, operations, [&] {
+			std::size_t total = 0;
+			for (std::size_t i = 0; i < operations; ++i)
+			{
+				total += ini.get(section(i)).get(key(i)).size();
+			}
+			bench::keep(total);
+		});
+		runner.run("structure_has", corpus, 0, operations, [&] {
+			std::size_t total = 0;
+			for (std::size_t i = 0; i < operations; ++i)
+			{
+				total += ini.has(section(i));
+			}
+			bench::keep(total);
+		});
+		runner.run("structure_set", corpus, 0, operations, [&] {
+			for (std::size_t i = 0; i < operations; ++i)
+			{
+				ini[section(i)].set(key(i), "changed");
+			}
+		});
+		runner.run("structure_iterate", corpus, 0, size, [&] {
+			std::size_t total = 0;
+			for (auto const& it : ini)
+			{
+				for (auto const& it2 : it.second)
+				{
+					total += it2.second.size();
+				}
+			}
+			bench::keep(total);
+		});
+		const std::size_t removals = std::min<std::size_t>(sectionCount, 1000);
+		runner.run("structure_remove", corpus, 0, removals, [&] {
+			for (std::size_t i = 0; i < removals; ++i)
+			{
+				ini["removed " + std::to_string(i)]["key"] = "value";
+			}
+		}, [&] {
+			for (std::size_t i = 0; i < removals; ++i)
+			{
+				ini.remove("removed " + std::to_string(i));
+			}
+		});
+	}
+}
+
+int main(int argc, char** argv)
+{
+	bench::Runner runner(suite, bench::parseOptions(argc, argv));
+	const double maxSize = 10000000.0 * runner.getOptions().scale;
+	for (std::size_t size = 1; static_cast<double>(size) <= maxSize; size *= 10)
+	{
+		for (const bool mixed : { false, true })
+		{
+			const std::string corpus = std::string((mixed) ? "mixed_" : "lower_") + std::to_string(size);
+			benchMap(runner, corpus, size, mixed);
+			benchStructure(runner, corpus, size, mixed);
+		}
+	}
+	return 0;
+}
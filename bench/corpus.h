@@ -0,0 +1,132 @@
+// Deterministic INI files of different shapes for the mINI benchmarks.
+//
+// The same shape and scale always produce the same bytes on every platform:
+// contents come from a fixed-seed splitmix64 generator and never from the
+// standard library's distributions, which differ between implementations.
+
+#ifndef MINI_BENCH_CORPUS_H_
+#define MINI_BENCH_CORPUS_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+
+namespace bench
+{
+	class Random
+	{
+	private:
+		std::uint64_t state;
+
+	public:
+		explicit Random(std::uint64_t seed)
+		: state(seed)
+		{ }
+
+		std::uint64_t next()
+		{
+			std::uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+			z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+			z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+			return z ^ (z >> 31);
+		}
+		std::size_t below(std::size_t bound)
+		{
+			return static_cast<std::size_t>(next() % bound);
+		}
+		void appendWord(std::string& output, std::size_t length)
+		{
+			static const char alphabet[] = "abcdefghijklmnopqrstuvwxyz0123456789_.";
+			for (std::size_t i = 0; i < length; ++i)
+			{
+				output += alphabet[below(sizeof(alphabet) - 1)];
+			}
+		}
+	};
+
+	struct Shape
+	{
+		const char* name;
+		std::size_t sections;
+		std::size_t keysPerSection;
+		std::size_t valueLength;
+		// comment lines and blank lines written before every key
+		std::size_t comments = 0;
+		bool crlf = false;
+		bool bom = false;
+		// every key contains an escaped "\=" sequence
+		bool escapedKeys = false;
+		// section names and keys use mixed case and padding
+		bool mixedCase = false;
+	};
+
+	const Shape shapes[] = {
+		{ "tiny_sections", 50000, 2, 8 },
+		{ "huge_sections", 4, 50000, 8 },
+		{ "long_values", 100, 10, 4096 },
+		{ "comments", 200, 100, 16, 3 },
+		{ "crlf", 200, 100, 16, 0, true },
+		{ "bom", 200, 100, 16, 0, false, true },
+		{ "escaped_keys", 200, 100, 16, 0, false, false, true },
+		{ "mixed_case", 200, 100, 16, 0, false, false, false, true }
+	};
+
+	struct Corpus
+	{
+		std::string contents;
+		std::size_t entries = 0;
+	};
+
+	// scale multiplies the number of sections, or of keys for shapes with
+	// only a few sections
+	inline Corpus makeCorpus(Shape const& shape, double scale)
+	{
+		auto scaled = [scale](std::size_t count) {
+			return std::max<std::size_t>(1, static_cast<std::size_t>(static_cast<double>(count) * scale));
+		};
+		const bool scaleKeys = (shape.sections < 10);
+		const std::size_t sections = (scaleKeys) ? shape.sections : scaled(shape.sections);
+		const std::size_t keys = (scaleKeys) ? scaled(shape.keysPerSection) : shape.keysPerSection;
+		const char* endl = (shape.crlf) ? "\r\n" : "\n";
+		Random random(0x6D494E49);
+		Corpus corpus;
+		auto& output = corpus.contents;
+		if (shape.bom)
+		{
+			output += "\xEF\xBB\xBF";
+		}
+		for (std::size_t s = 0; s < sections; ++s)
+		{
+			output += (shape.mixedCase) ? "[  Section_" : "[section_";
+			output += std::to_string(s);
+			output += (shape.mixedCase) ? "  ]" : "]";
+			output += endl;
+			for (std::size_t k = 0; k < keys; ++k)
+			{
+				for (std::size_t c = 0; c < shape.comments; ++c)
+				{
+					output += "; ";
+					random.appendWord(output, 24);
+					output += endl;
+				}
+				if (shape.comments != 0)
+				{
+					output += endl;
+				}
+				output += (shape.mixedCase) ? "  Key_" : "key_";
+				if (shape.escapedKeys)
+				{
+					output += "a\\=b\\=";
+				}
+				output += std::to_string(k);
+				output += " = ";
+				random.appendWord(output, shape.valueLength);
+				output += endl;
+			}
+		}
+		corpus.entries = sections * keys;
+		return corpus;
+	}
+}
+
+#endif // MINI_BENCH_CORPUS_H_
@@ -0,0 +1,197 @@
+// Hardware performance counters for the mINI benchmarks.
+//
+// On Linux, Counters opens cycles, instructions, branch misses, L1 data
+// cache read misses and last-level cache misses through perf_event_open.
+// They count the calling thread in user space only, so the numbers belong
+// to the benchmark body rather than to the kernel or other processes.
+//
+// Counters that can't be opened are left out: virtual machines and
+// containers often have no PMU, perf_event_paranoid may forbid access, and
+// other systems have no perf_event_open at all. The benchmarks then run and
+// report times as before. If the kernel has to share the hardware between
+// more events than it has registers, values are scaled by the time each
+// counter actually ran.
+
+#ifndef MINI_BENCH_COUNTERS_H_
+#define MINI_BENCH_COUNTERS_H_
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#if defined(__linux__)
+#include <cerrno>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace bench
+{
+	class Counters
+	{
+	public:
+		static constexpr std::size_t N_counters = 5;
+
+	private:
+		struct T_Counter
+		{
+			const char* name;
+			std::uint32_t type;
+			std::uint64_t config;
+			int fd = -1;
+			std::uint64_t value = 0;
+		};
+
+		std::array<T_Counter, N_counters> counters;
+		std::string error;
+
+#if defined(__linux__)
+		static constexpr std::uint64_t cacheReadMiss(std::uint64_t cache)
+		{
+			return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+		}
+		static int open(std::uint32_t type, std::uint64_t config)
+		{
+			perf_event_attr attr;
+			std::memset(&attr, 0, sizeof(attr));
+			attr.size = sizeof(attr);
+			attr.type = type;
+			attr.config = config;
+			attr.disabled = 1;
+			attr.exclude_kernel = 1;
+			attr.exclude_hv = 1;
+			attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+			return static_cast<int>(::syscall(SYS_perf_event_open, &attr, 0, -1, -1, PERF_FLAG_FD_CLOEXEC));
+		}
+#endif
+
+	public:
+		explicit Counters(bool enabled)
+		: counters {{
+#if defined(__linux__)
+			{ "cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+			{ "instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+			{ "branch_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+			{ "l1d_misses", PERF_TYPE_HW_CACHE, cacheReadMiss(PERF_COUNT_HW_CACHE_L1D) },
+			{ "llc_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES }
+#else
+			{ "cycles", 0, 0 },
+			{ "instructions", 0, 0 },
+			{ "branch_misses", 0, 0 },
+			{ "l1d_misses", 0, 0 },
+			{ "llc_misses", 0, 0 }
+#endif
+		}}
+		{
+			if (!enabled)
+			{
+				return;
+			}
+#if defined(__linux__)
+			for (auto& counter : counters)
+			{
+				counter.fd = open(counter.type, counter.config);
+				if (counter.fd < 0 && error.empty())
+				{
+					error = std::string(counter.name) + ": " + std::strerror(errno);
+				}
+			}
+#else
+			error = "perf_event_open is only available on Linux";
+#endif
+		}
+		~Counters()
+		{
+#if defined(__linux__)
+			for (auto const& counter : counters)
+			{
+				if (counter.fd >= 0)
+				{
+					::close(counter.fd);
+				}
+			}
+#endif
+		}
+
+		Counters(Counters const&) = delete;
+		Counters& operator=(Counters const&) = delete;
+
+		[[nodiscard]] bool any() const
+		{
+			for (auto const& counter : counters)
+			{
+				if (counter.fd >= 0)
+				{
+					return true;
+				}
+			}
+			return false;
+		}
+		// why the first counter that is missing couldn't be opened
+		[[nodiscard]] std::string const& getError() const
+		{
+			return error;
+		}
+
+		void start()
+		{
+#if defined(__linux__)
+			for (auto const& counter : counters)
+			{
+				if (counter.fd >= 0)
+				{
+					::ioctl(counter.fd, PERF_EVENT_IOC_RESET, 0);
+					::ioctl(counter.fd, PERF_EVENT_IOC_ENABLE, 0);
+				}
+			}
+#endif
+		}
+		void stop()
+		{
+#if defined(__linux__)
+			for (auto const& counter : counters)
+			{
+				if (counter.fd >= 0)
+				{
+					::ioctl(counter.fd, PERF_EVENT_IOC_DISABLE, 0);
+				}
+			}
+			for (auto& counter : counters)
+			{
+				if (counter.fd < 0)
+				{
+					continue;
+				}
+				// value, time enabled, time running
+				std::uint64_t values[3] = {};
+				if (::read(counter.fd, values, sizeof(values)) != static_cast<ssize_t>(sizeof(values)) || values[2] == 0)
+				{
+					counter.value = 0;
+					continue;
+				}
+				counter.value = (values[1] == values[2])
+					? values[0]
+					: static_cast<std::uint64_t>(static_cast<double>(values[0]) * static_cast<double>(values[1]) / static_cast<double>(values[2]));
+			}
+#endif
+		}
+
+		[[nodiscard]] bool has(std::size_t i) const
+		{
+			return counters[i].fd >= 0;
+		}
+		[[nodiscard]] const char* name(std::size_t i) const
+		{
+			return counters[i].name;
+		}
+		// counted between the last start() and stop()
+		[[nodiscard]] std::uint64_t value(std::size_t i) const
+		{
+			return counters[i].value;
+		}
+	};
+}
+
+#endif // MINI_BENCH_COUNTERS_H_
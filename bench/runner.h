@@ -0,0 +1,206 @@
+// Timing and result output shared by the mINI benchmarks.
+//
+// Each benchmark runs a number of times; its setup runs before every
+// repetition and is not timed. Results are printed to stdout as one JSON
+// object per line, so runs can be stored and compared between releases:
+//
+//   {"suite":"file","name":"read","corpus":"crlf","bytes":...,"entries":...,
+//    "repeat":5,"min_ns":...,"median_ns":...,"mb_s":...,"ns_entry":...}
+//
+// Where hardware counters are available (see counters.h), each line also
+// holds the counts from the fastest repetition, per byte and per entry:
+//
+//   ...,"cycles":...,"cycles_byte":...,"cycles_entry":...,"ipc":...}
+//
+// Command line: [filter] [--repeat N] [--scale F] [--no-counters]. Only
+// benchmarks whose "name/corpus" contains the filter run; --scale
+// multiplies input sizes.
+
+#ifndef MINI_BENCH_RUNNER_H_
+#define MINI_BENCH_RUNNER_H_
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "counters.h"
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+namespace bench
+{
+	struct Options
+	{
+		std::string filter;
+		int repeat = 5;
+		double scale = 1.0;
+		bool counters = true;
+	};
+
+	inline Options parseOptions(int argc, char** argv)
+	{
+		Options options;
+		for (int i = 1; i < argc; ++i)
+		{
+			if (std::strcmp(argv[i], "--repeat") == 0 && i + 1 < argc)
+			{
+				options.repeat = std::max(1, std::atoi(argv[++i]));
+			}
+			else if (std::strcmp(argv[i], "--scale") == 0 && i + 1 < argc)
+			{
+				options.scale = std::max(0.0, std::atof(argv[++i]));
+			}
+			else if (std::strcmp(argv[i], "--no-counters") == 0)
+			{
+				options.counters = false;
+			}
+			else
+			{
+				options.filter = argv[i];
+			}
+		}
+		return options;
+	}
+
+	// keeps the compiler from dropping work whose result is otherwise unused
+	inline void keep(std::uintmax_t value)
+	{
+#if defined(_MSC_VER) && !defined(__clang__)
+		// no inline assembly on MSVC: store through a volatile pointer and
+		// keep the store from being reordered
+		static std::uintmax_t sink;
+		*static_cast<std::uintmax_t volatile*>(&sink) = value;
+		_ReadWriteBarrier();
+#else
+		// the value has to be in a register or memory, and the empty
+		// statement may read or write any memory
+		asm volatile("" : : "r,m"(value) : "memory");
+#endif
+	}
+
+	class Runner
+	{
+	private:
+		using T_Clock = std::chrono::steady_clock;
+
+		Options options;
+		const char* suite;
+		Counters counters;
+
+		static void appendf(std::string& output, const char* format, double value)
+		{
+			char buffer[64];
+			std::snprintf(buffer, sizeof(buffer), format, value);
+			output += buffer;
+		}
+		void appendCounters(std::string& output, std::uint64_t const* values, std::size_t bytes, std::size_t entries) const
+		{
+			for (std::size_t i = 0; i < Counters::N_counters; ++i)
+			{
+				if (!counters.has(i))
+				{
+					continue;
+				}
+				const auto value = static_cast<double>(values[i]);
+				output += std::string(",\"") + counters.name(i) + "\":";
+				appendf(output, "%.0f", value);
+				if (bytes > 0)
+				{
+					output += std::string(",\"") + counters.name(i) + "_byte\":";
+					appendf(output, "%.4f", value / static_cast<double>(bytes));
+				}
+				if (entries > 0)
+				{
+					output += std::string(",\"") + counters.name(i) + "_entry\":";
+					appendf(output, "%.3f", value / static_cast<double>(entries));
+				}
+			}
+			// cycles and instructions come first
+			if (counters.has(0) && counters.has(1) && values[0] > 0)
+			{
+				output += ",\"ipc\":";
+				appendf(output, "%.3f", static_cast<double>(values[1]) / static_cast<double>(values[0]));
+			}
+		}
+
+	public:
+		Runner(const char* suite, Options options)
+		: options(std::move(options))
+		, suite(suite)
+		, counters(this->options.counters)
+		{
+			if (this->options.counters && !counters.getError().empty())
+			{
+				std::fprintf(stderr, "%s hardware counters unavailable (%s)\n", (counters.any()) ? "some" : "all", counters.getError().c_str());
+			}
+		}
+
+		[[nodiscard]] Options const& getOptions() const
+		{
+			return options;
+		}
+		[[nodiscard]] std::size_t scaled(std::size_t count) const
+		{
+			return std::max<std::size_t>(1, static_cast<std::size_t>(static_cast<double>(count) * options.scale));
+		}
+		[[nodiscard]] bool selected(std::string const& name, std::string const& corpus) const
+		{
+			return (name + "/" + corpus).find(options.filter) != std::string::npos;
+		}
+
+		template<typename T_Setup, typename T_Body>
+		void run(std::string const& name, std::string const& corpus, std::size_t bytes, std::size_t entries, T_Setup&& setup, T_Body&& body)
+		{
+			if (!selected(name, corpus))
+			{
+				return;
+			}
+			std::vector<double> times;
+			std::uint64_t fastestCounts[Counters::N_counters] = {};
+			for (int i = 0; i < options.repeat; ++i)
+			{
+				setup();
+				// counters are switched on and off outside of the timed region
+				counters.start();
+				const auto start = T_Clock::now();
+				body();
+				const auto end = T_Clock::now();
+				counters.stop();
+				times.push_back(std::chrono::duration<double, std::nano>(end - start).count());
+				if (times.back() <= *std::min_element(times.begin(), times.end()))
+				{
+					for (std::size_t j = 0; j < Counters::N_counters; ++j)
+					{
+						fastestCounts[j] = counters.value(j);
+					}
+				}
+			}
+			std::sort(times.begin(), times.end());
+			const double minNs = times.front();
+			const double medianNs = times[times.size() / 2];
+			std::string countersOutput;
+			appendCounters(countersOutput, fastestCounts, bytes, entries);
+			std::printf(
+				"{\"suite\":\"%s\",\"name\":\"%s\",\"corpus\":\"%s\",\"bytes\":%zu,\"entries\":%zu,"
+				"\"repeat\":%d,\"min_ns\":%.0f,\"median_ns\":%.0f,\"mb_s\":%.3f,\"ns_entry\":%.3f%s}\n",
+				suite, name.c_str(), corpus.c_str(), bytes, entries, options.repeat, minNs, medianNs,
+				(minNs > 0) ? static_cast<double>(bytes) * 1e3 / minNs : 0.0,
+				(entries > 0) ? minNs / static_cast<double>(entries) : 0.0,
+				countersOutput.c_str()
+			);
+			std::fflush(stdout);
+		}
+		template<typename T_Body>
+		void run(std::string const& name, std::string const& corpus, std::size_t bytes, std::size_t entries, T_Body&& body)
+		{
+			run(name, corpus, bytes, entries, [] {}, std::forward<T_Body>(body));
+		}
+	};
+}
+
+#endif // MINI_BENCH_RUNNER_H_
@@ -0,0 +1,397 @@
+/*
+ * The MIT License (MIT)
+ * Copyright (c) 2018 Danijel Durakovic
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+///////////////////////////////////////////////////////////////////////////////
+//
+//  /mINI/ asynchronous writer
+//  Writes INI files on a background thread.
+//
+///////////////////////////////////////////////////////////////////////////////
+//
+//  INIAsyncWriter takes a copy of the structure and returns right away; the
+//  file is written later on the writer thread, the same way INIFile::write()
+//  would write it. The returned future tells whether the write succeeded.
+//
+//  Writes to a file that is still queued replace the queued structure and
+//  share its future, so a file that is written often is only written once
+//  per batch. Paths are compared after resolving them, so "a.ini" and
+//  "./a.ini" are the same file. The writer thread takes all queued files at once, writes each
+//  to a temporary file in the same directory, syncs all of them and then
+//  renames them over the originals; on POSIX systems the directories are
+//  synced once per batch as well. Readers see either the old or the new
+//  version of a file.
+//
+//  The queue holds at most `capacity` files. write() blocks while the queue
+//  is full, unless the file is already queued. flush() waits until all
+//  queued files are written.
+//
+///////////////////////////////////////////////////////////////////////////////
+//
+//  /* BASIC USAGE EXAMPLE: */
+//
+//  mINI::INIAsyncWriter writer;
+//
+//  /* any thread */
+//  auto result = writer.write("myfile.ini", ini);
+//
+//  /* wait for a single write, or for all of them */
+//  bool writeSuccess = result.get();
+//  writer.flush();
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef MINI_ASYNC_H_
+#define MINI_ASYNC_H_
+
+#include <condition_variable>
+#include <future>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <thread>
+#include "ini.h"
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace mINI
+{
+	class INIAsyncWriter
+	{
+	public:
+		using T_Result = std::shared_future<bool>;
+
+	private:
+		struct T_Request
+		{
+			std::filesystem::path filename;
+			INIStructure data;
+			bool pretty = false;
+			std::promise<bool> promise;
+			T_Result result;
+			// the file the path refers to once symlinks are followed
+			std::filesystem::path target;
+			std::filesystem::path tempFilename;
+			bool success = false;
+		};
+		using T_Requests = std::vector<T_Request>;
+
+		std::mutex queueMutex;
+		std::condition_variable queueChanged;
+		T_Requests queue;
+		std::unordered_map<std::string, std::size_t> queueIndex;
+		std::size_t capacity;
+		bool busy = false;
+		bool failed = false;
+		bool stopping = false;
+		std::thread writerThread;
+
+		// different spellings of the same path share a place in the queue
+		static std::string getKey(std::filesystem::path const& filename)
+		{
+			std::error_code ec;
+			auto path = std::filesystem::absolute(filename, ec);
+			if (ec)
+			{
+				return filename.lexically_normal().string();
+			}
+			auto canonicalPath = std::filesystem::weakly_canonical(path, ec);
+			return ((ec) ? path.lexically_normal() : canonicalPath).string();
+		}
+		static bool readContents(std::filesystem::path const& filename, std::string& contents)
+		{
+			std::ifstream fileReadStream(filename, std::ios::in | std::ios::binary);
+			if (!fileReadStream.is_open())
+			{
+				return false;
+			}
+			std::ostringstream contentsStream;
+			contentsStream << fileReadStream.rdbuf();
+			contents = contentsStream.str();
+			return true;
+		}
+		static bool render(T_Request const& request, std::string& contents)
+		{
+			std::error_code ec;
+			const bool exists = std::filesystem::exists(request.filename, ec);
+			if (ec)
+			{
+				return false;
+			}
+			if (!exists)
+			{
+				INIGenerator generator;
+				generator.prettyPrint = request.pretty;
+				return generator.generate(request.data, contents);
+			}
+			if (!readContents(request.filename, contents))
+			{
+				return false;
+			}
+			INIWriter writer;
+			writer.prettyPrint = request.pretty;
+			return writer.update(contents, request.data);
+		}
+#if defined(__unix__) || defined(__APPLE__)
+		static bool syncFile(int fd)
+		{
+#ifdef __APPLE__
+			return ::fsync(fd) == 0;
+#else
+			return ::fdatasync(fd) == 0;
+#endif
+		}
+		// writes contents to a new temporary file, returning its descriptor
+		static int writeTemp(T_Request& request, std::string_view contents)
+		{
+			request.target = INIWriter::resolveSymlinks(request.filename);
+			const int fd = INIWriter::openTempFile(request.target, request.tempFilename);
+			if (fd < 0)
+			{
+				return -1;
+			}
+			struct stat fileStat;
+			if (::stat(request.target.c_str(), &fileStat) == 0)
+			{
+				INIWriter::copyAttributes(fd, fileStat);
+			}
+			while (!contents.empty())
+			{
+				const auto written = ::write(fd, contents.data(), contents.size());
+				if (written < 0)
+				{
+					::close(fd);
+					return -1;
+				}
+				contents.remove_prefix(static_cast<std::size_t>(written));
+			}
+			return fd;
+		}
+		static void process(T_Requests& batch)
+		{
+			std::vector<int> fds(batch.size(), -1);
+			std::string contents;
+			for (std::size_t i = 0; i < batch.size(); ++i)
+			{
+				auto& request = batch[i];
+				try
+				{
+					if (render(request, contents))
+					{
+						fds[i] = writeTemp(request, contents);
+					}
+				}
+				catch (...)
+				{
+					// the request fails, the rest of the batch goes on
+				}
+			}
+			// all files are synced before any of them replaces its original
+			for (std::size_t i = 0; i < batch.size(); ++i)
+			{
+				if (fds[i] >= 0)
+				{
+					batch[i].success = syncFile(fds[i]);
+					batch[i].success = (::close(fds[i]) == 0) && batch[i].success;
+				}
+			}
+			std::set<std::filesystem::path> directories;
+			for (auto& request : batch)
+			{
+				if (request.success && ::rename(request.tempFilename.c_str(), request.target.c_str()) == 0)
+				{
+					directories.insert(request.target.parent_path());
+				}
+				else
+				{
+					request.success = false;
+					if (!request.tempFilename.empty())
+					{
+						::unlink(request.tempFilename.c_str());
+					}
+				}
+			}
+			for (auto const& directory : directories)
+			{
+				const int fd = ::open((directory.empty()) ? "." : directory.c_str(), O_RDONLY);
+				if (fd >= 0)
+				{
+					::fsync(fd);
+					::close(fd);
+				}
+			}
+		}
+#else
+		static void process(T_Requests& batch)
+		{
+			std::string contents;
+			for (auto& request : batch)
+			{
+				try
+				{
+					std::error_code ec;
+					request.target = INIWriter::resolveSymlinks(request.filename);
+					do
+					{
+						request.tempFilename = INIWriter::getTempFilename(request.target);
+					} while (std::filesystem::exists(request.tempFilename, ec) && !ec);
+					if (!ec && render(request, contents))
+					{
+						std::ofstream fileWriteStream(request.tempFilename, std::ios::out | std::ios::binary);
+						fileWriteStream.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+						fileWriteStream.close();
+						request.success = !fileWriteStream.fail();
+					}
+				}
+				catch (...)
+				{
+					request.success = false;
+				}
+			}
+			for (auto& request : batch)
+			{
+				std::error_code ec;
+				if (request.success)
+				{
+					std::filesystem::rename(request.tempFilename, request.target, ec);
+				}
+				if (!request.success || ec)
+				{
+					request.success = false;
+					std::filesystem::remove(request.tempFilename, ec);
+				}
+			}
+		}
+#endif
+
+		void run()
+		{
+			T_Requests batch;
+			for (;;)
+			{
+				{
+					std::unique_lock<std::mutex> lock(queueMutex);
+					queueChanged.wait(lock, [this] { return stopping || !queue.empty(); });
+					if (queue.empty())
+					{
+						return;
+					}
+					batch.swap(queue);
+					queueIndex.clear();
+					busy = true;
+				}
+				queueChanged.notify_all();
+				try
+				{
+					process(batch);
+				}
+				catch (...)
+				{
+					// nothing may leave the writer thread; whatever wasn't
+					// renamed yet has failed
+					for (auto& request : batch)
+					{
+						std::error_code ec;
+						if (!request.tempFilename.empty() && std::filesystem::exists(request.tempFilename, ec))
+						{
+							request.success = false;
+							std::filesystem::remove(request.tempFilename, ec);
+						}
+					}
+				}
+				bool batchFailed = false;
+				for (auto& request : batch)
+				{
+					batchFailed = batchFailed || !request.success;
+					request.promise.set_value(request.success);
+				}
+				batch.clear();
+				{
+					std::lock_guard<std::mutex> lock(queueMutex);
+					busy = false;
+					failed = failed || batchFailed;
+				}
+				queueChanged.notify_all();
+			}
+		}
+
+	public:
+		explicit INIAsyncWriter(std::size_t capacity = 1024)
+		: capacity(std::max<std::size_t>(capacity, 1))
+		{
+			writerThread = std::thread(&INIAsyncWriter::run, this);
+		}
+		// writes everything still queued before returning
+		~INIAsyncWriter()
+		{
+			{
+				std::lock_guard<std::mutex> lock(queueMutex);
+				stopping = true;
+			}
+			queueChanged.notify_all();
+			writerThread.join();
+		}
+
+		INIAsyncWriter(INIAsyncWriter const&) = delete;
+		INIAsyncWriter& operator=(INIAsyncWriter const&) = delete;
+
+		T_Result write(std::filesystem::path filename, INIStructure data, bool pretty = false)
+		{
+			const std::string key = getKey(filename);
+			std::unique_lock<std::mutex> lock(queueMutex);
+			queueChanged.wait(lock, [&] { return queue.size() < capacity || queueIndex.count(key) == 1; });
+			auto it = queueIndex.find(key);
+			if (it != queueIndex.end())
+			{
+				auto& request = queue[it->second];
+				request.data = std::move(data);
+				request.pretty = pretty;
+				return request.result;
+			}
+			queueIndex.emplace(key, queue.size());
+			auto& request = queue.emplace_back();
+			request.filename = std::move(filename);
+			request.data = std::move(data);
+			request.pretty = pretty;
+			request.result = request.promise.get_future().share();
+			T_Result result = request.result;
+			lock.unlock();
+			queueChanged.notify_all();
+			return result;
+		}
+		// waits until all queued files are written; false if any write
+		// failed since the last flush
+		bool flush()
+		{
+			std::unique_lock<std::mutex> lock(queueMutex);
+			queueChanged.wait(lock, [this] { return queue.empty() && !busy; });
+			const bool success = !failed;
+			failed = false;
+			return success;
+		}
+	};
+}
+
+#endif // MINI_ASYNC_H_
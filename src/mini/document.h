@@ -0,0 +1,720 @@
+/*
+ * The MIT License (MIT)
+ * Copyright (c) 2018 Danijel Durakovic
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+///////////////////////////////////////////////////////////////////////////////
+//
+//  /mINI/ documents
+//  Editable INI files that keep their comments and formatting in memory.
+//
+///////////////////////////////////////////////////////////////////////////////
+//
+//  INIDocument holds every line of a file, including comments, blank lines
+//  and lines it doesn't understand. Key lines are split into the text in
+//  front of the value, the value and trailing whitespace, and each line
+//  keeps its own line ending. An index maps section and key names (trimmed
+//  and case insensitive unless MINI_CASE_SENSITIVE is defined) to their
+//  lines, so reading, changing, adding or removing a key touches only the
+//  lines involved. Saving writes the lines out as they are in one pass.
+//
+//  Documents follow the same rules as INIStructure: keys outside of a
+//  section are kept as plain text, and for keys that appear more than once
+//  the last value wins. Changing such a key updates every occurrence.
+//
+///////////////////////////////////////////////////////////////////////////////
+//
+//  /* BASIC USAGE EXAMPLE: */
+//
+//  mINI::INIDocument document;
+//  document.read("myfile.ini");
+//
+//  /* edit values in place */
+//  document.set("section", "key", "value");
+//  document.remove("section", "old key");
+//
+//  /* or apply changes made to a structure */
+//  mINI::INIStructure ini;
+//  document.copyTo(ini);
+//  ini["section"]["key"] = "value";
+//  document.update(ini);
+//
+//  /* save, keeping comments and formatting */
+//  document.write("myfile.ini");
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef MINI_DOCUMENT_H_
+#define MINI_DOCUMENT_H_
+
+#include <list>
+#include "ini.h"
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace mINI
+{
+	class INIDocument
+	{
+	private:
+		struct T_Section;
+
+		enum class T_LineType : char
+		{
+			LINE_OTHER,
+			LINE_SECTION,
+			LINE_KEY
+		};
+
+		struct T_Line
+		{
+			T_LineType type = T_LineType::LINE_OTHER;
+			// whole line, or everything in front of the value for keys
+			std::string text;
+			std::string value;
+			// whitespace following the value
+			std::string suffix;
+			// "\n", "\r\n" or "" for the last line
+			const char* ending = "";
+			T_Section* section = nullptr;
+			std::string key;
+			// where the line was, how long it was and a hash of its bytes when
+			// the file was last read or written, and whether it changed since
+			std::size_t offset = std::string::npos;
+			std::size_t length = 0;
+			std::size_t hash = 0;
+			bool changed = false;
+
+			std::size_t size() const
+			{
+				return text.size() + value.size() + suffix.size() + std::char_traits<char>::length(ending);
+			}
+			void render(std::string& output) const
+			{
+				output += text;
+				output += value;
+				output += suffix;
+				output += ending;
+			}
+		};
+
+		// a line of the synced file that was erased since
+		struct T_SyncedLine
+		{
+			std::size_t offset;
+			std::size_t length;
+			std::size_t hash;
+		};
+
+		using T_Lines = std::list<T_Line>;
+		using T_LineIt = T_Lines::iterator;
+		using T_KeyLines = std::unordered_map<std::string, std::vector<T_LineIt>>;
+
+		struct T_Section
+		{
+			std::string name;
+			std::vector<T_LineIt> headers;
+			T_KeyLines keys;
+			// new keys are added after this line
+			T_LineIt last;
+		};
+
+		using T_Sections = std::unordered_map<std::string, T_Section>;
+
+		T_Lines lines;
+		T_Sections sections;
+		const char* newline = INIStringUtil::endl;
+		// file the lines were last read from or written to
+		std::filesystem::path syncedFile;
+		INIFileStamp syncedStamp;
+		std::size_t syncedSize = 0;
+		std::vector<T_SyncedLine> erasedLines;
+		bool syncedBOM = false;
+		bool synced = false;
+
+		static std::string normalize(std::string_view name)
+		{
+			std::string result(INIStringUtil::trimView(name));
+#ifndef MINI_CASE_SENSITIVE
+			INIStringUtil::toLower(result);
+#endif
+			return result;
+		}
+		static void splitKeyLine(T_Line& line, std::string_view text, std::string_view value)
+		{
+			if (value.empty())
+			{
+				const auto end = text.find_last_not_of(INIStringUtil::whitespaceDelimiters) + 1;
+				line.text = text.substr(0, end);
+				line.suffix = text.substr(end);
+				return;
+			}
+			const auto valueAt = static_cast<std::size_t>(value.data() - text.data());
+			line.text = text.substr(0, valueAt);
+			line.value = value;
+			line.suffix = text.substr(valueAt + value.size());
+		}
+
+		T_LineIt insertAfter(T_LineIt position)
+		{
+			auto line = lines.emplace(std::next(position));
+			// a line added after the last one takes over its ending
+			line->ending = position->ending;
+			if (*position->ending == '\0')
+			{
+				position->ending = newline;
+				position->changed = true;
+			}
+			return line;
+		}
+		T_LineIt append()
+		{
+			return (lines.empty()) ? lines.emplace(lines.end()) : insertAfter(std::prev(lines.end()));
+		}
+		void erase(T_LineIt first, T_LineIt last)
+		{
+			if (last == lines.end() && first != lines.begin())
+			{
+				auto previous = std::prev(first);
+				previous->ending = std::prev(last)->ending;
+				previous->changed = true;
+			}
+			for (auto line = first; synced && line != last; ++line)
+			{
+				if (line->offset != std::string::npos)
+				{
+					erasedLines.push_back({ line->offset, line->length, line->hash });
+				}
+			}
+			lines.erase(first, last);
+		}
+		T_Section& addSection(std::string const& name, std::string_view title)
+		{
+			auto& section = sections[name];
+			section.name = name;
+			if (prettyPrint && !lines.empty() && !lines.back().text.empty())
+			{
+				append();
+			}
+			auto line = append();
+			line->type = T_LineType::LINE_SECTION;
+			line->text.reserve(title.size() + 2);
+			line->text += '[';
+			line->text += title;
+			line->text += ']';
+			line->section = &section;
+			section.headers.emplace_back(line);
+			section.last = line;
+			return section;
+		}
+		void setKey(T_Section& section, std::string const& name, std::string_view title, std::string_view value)
+		{
+			value = INIStringUtil::trimView(value);
+			auto it = section.keys.find(name);
+			if (it != section.keys.end())
+			{
+				for (auto& line : it->second)
+				{
+					if (line->value != value)
+					{
+						line->value = value;
+						line->changed = true;
+					}
+				}
+				return;
+			}
+			auto line = insertAfter(section.last);
+			line->type = T_LineType::LINE_KEY;
+			line->text.reserve(title.size() + 3);
+			for (const char c : title)
+			{
+				if (c == '=')
+				{
+					line->text += '\\';
+				}
+				line->text += c;
+			}
+			line->text += (prettyPrint) ? " = " : "=";
+			line->value = value;
+			line->section = &section;
+			line->key = name;
+			section.keys[name].emplace_back(line);
+			section.last = line;
+		}
+		void eraseKey(T_Section& section, T_KeyLines::iterator it)
+		{
+			for (auto line : it->second)
+			{
+				if (section.last == line)
+				{
+					// move back to the previous key of the section or its header
+					do
+					{
+						--section.last;
+					}
+					while (section.last->section != &section);
+				}
+				erase(line, std::next(line));
+			}
+			section.keys.erase(it);
+		}
+		void setSynced(std::filesystem::path const& filename, INIFileStamp const& stamp)
+		{
+			std::string buffer;
+			std::size_t position = (isBOM) ? 3 : 0;
+			for (auto& line : lines)
+			{
+				buffer.clear();
+				line.render(buffer);
+				line.offset = position;
+				line.length = buffer.size();
+				line.hash = std::hash<std::string_view>()(buffer);
+				line.changed = false;
+				position += line.length;
+			}
+			erasedLines.clear();
+			syncedFile = filename;
+			syncedStamp = stamp;
+			syncedSize = position;
+			syncedBOM = isBOM;
+			synced = true;
+		}
+#if defined(__unix__) || defined(__APPLE__)
+		static bool writeAt(int fd, std::string_view data, std::size_t offset)
+		{
+			while (!data.empty())
+			{
+				const auto written = ::pwrite(fd, data.data(), data.size(), static_cast<off_t>(offset));
+				if (written < 0)
+				{
+					return false;
+				}
+				data.remove_prefix(static_cast<std::size_t>(written));
+				offset += static_cast<std::size_t>(written);
+			}
+			return true;
+		}
+		static bool matchesAt(int fd, std::string& buffer, std::size_t offset, std::size_t length, std::size_t hash)
+		{
+			buffer.resize(length);
+			std::size_t done = 0;
+			while (done < length)
+			{
+				const auto got = ::pread(fd, &buffer[done], length - done, static_cast<off_t>(offset + done));
+				if (got <= 0)
+				{
+					return false;
+				}
+				done += static_cast<std::size_t>(got);
+			}
+			return std::hash<std::string_view>()(buffer) == hash;
+		}
+		// the first line that moved since the file was synced; lines before
+		// it kept their place and length
+		T_LineIt firstMoved(std::size_t& position)
+		{
+			position = (isBOM) ? 3 : 0;
+			auto line = lines.begin();
+			for (; line != lines.end() && line->offset == position; ++line)
+			{
+				if (line->changed && line->size() != line->length)
+				{
+					break;
+				}
+				position += line->length;
+			}
+			return line;
+		}
+		// whether the bytes patching would replace are still the ones the
+		// lines were synced with
+		bool matchesFile(int fd)
+		{
+			std::string buffer;
+			std::size_t position;
+			firstMoved(position);
+			for (auto const& line : lines)
+			{
+				const bool replaced = (line.offset != std::string::npos) && (line.changed || line.offset >= position);
+				if (replaced && !matchesAt(fd, buffer, line.offset, line.length, line.hash))
+				{
+					return false;
+				}
+			}
+			for (auto const& line : erasedLines)
+			{
+				if (line.offset >= position && !matchesAt(fd, buffer, line.offset, line.length, line.hash))
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+		bool patchFile(int fd)
+		{
+			std::string buffer;
+			std::size_t position;
+			const auto moved = firstMoved(position);
+			// lines that kept their place and length are overwritten where they are
+			for (auto line = lines.begin(); line != moved; ++line)
+			{
+				if (line->changed)
+				{
+					buffer.clear();
+					line->render(buffer);
+					if (!writeAt(fd, buffer, line->offset))
+					{
+						return false;
+					}
+				}
+			}
+			if (moved == lines.end() && position == syncedSize)
+			{
+				return true;
+			}
+			// everything after the first line that moved is written again
+			buffer.clear();
+			for (auto line = moved; line != lines.end(); ++line)
+			{
+				line->render(buffer);
+			}
+			return (
+				writeAt(fd, buffer, position) &&
+				::ftruncate(fd, static_cast<off_t>(position + buffer.size())) == 0
+			);
+		}
+#endif
+		void eraseSection(T_Sections::iterator it)
+		{
+			// a section takes all lines up to the next section with it
+			for (auto header : it->second.headers)
+			{
+				auto end = std::next(header);
+				while (end != lines.end() && end->type != T_LineType::LINE_SECTION)
+				{
+					++end;
+				}
+				erase(header, end);
+			}
+			sections.erase(it);
+		}
+
+	public:
+		bool prettyPrint = false;
+		bool isBOM = false;
+
+		INIDocument() = default;
+		INIDocument(INIDocument const&) = delete;
+		INIDocument(INIDocument&&) = default;
+		INIDocument& operator=(INIDocument const&) = delete;
+		INIDocument& operator=(INIDocument&&) = default;
+		~INIDocument() = default;
+
+		static INIDocument fromString(std::string_view contents)
+		{
+			INIDocument document;
+			document.parse(contents);
+			return document;
+		}
+
+		void parse(std::string_view contents)
+		{
+			clear();
+			synced = false;
+			isBOM = (contents.substr(0, 3) == "\xEF\xBB\xBF");
+			if (isBOM)
+			{
+				contents.remove_prefix(3);
+			}
+			bool newlineFound = false;
+			T_Section* section = nullptr;
+			INIParser::T_ParseViews parseData;
+			std::string key;
+			while (!contents.empty())
+			{
+				const auto newlineAt = contents.find('\n');
+				auto text = contents.substr(0, newlineAt);
+				auto& line = lines.emplace_back();
+				if (newlineAt == std::string_view::npos)
+				{
+					contents = std::string_view();
+				}
+				else
+				{
+					contents.remove_prefix(newlineAt + 1);
+					line.ending = "\n";
+					if (!text.empty() && text.back() == '\r')
+					{
+						text.remove_suffix(1);
+						line.ending = "\r\n";
+					}
+					if (!newlineFound)
+					{
+						newline = line.ending;
+						newlineFound = true;
+					}
+				}
+				const auto parseResult = INIParser::parseLine(text, parseData);
+				if (parseResult == INIParser::PDataType::PDATA_SECTION)
+				{
+					const auto name = normalize(parseData.first);
+					section = &sections[name];
+					section->name = name;
+					section->headers.emplace_back(std::prev(lines.end()));
+					section->last = std::prev(lines.end());
+					line.type = T_LineType::LINE_SECTION;
+					line.text = text;
+					line.section = section;
+				}
+				else if (parseResult == INIParser::PDataType::PDATA_KEYVALUE && section != nullptr)
+				{
+					INIStringUtil::unescapeKey(key, parseData.first);
+					line.type = T_LineType::LINE_KEY;
+					line.key = normalize(key);
+					line.section = section;
+					splitKeyLine(line, text, parseData.second);
+					section->keys[line.key].emplace_back(std::prev(lines.end()));
+					section->last = std::prev(lines.end());
+				}
+				else
+				{
+					line.text = text;
+				}
+			}
+		}
+		bool read(std::filesystem::path const& filename)
+		{
+			INIFileStamp stamp;
+			const bool hasStamp = stamp.read(filename);
+			std::ifstream fileReadStream(filename, std::ios::in | std::ios::binary);
+			if (!fileReadStream.is_open())
+			{
+				return false;
+			}
+			std::string contents(
+				(std::istreambuf_iterator<char>(fileReadStream)),
+				std::istreambuf_iterator<char>()
+			);
+			parse(contents);
+			if (hasStamp)
+			{
+				setSynced(filename, stamp);
+			}
+			return true;
+		}
+		void render(std::string& output) const
+		{
+			std::size_t outputSize = (isBOM) ? 3 : 0;
+			for (auto const& line : lines)
+			{
+				outputSize += line.text.size() + line.value.size() + line.suffix.size() + 2;
+			}
+			output.clear();
+			output.reserve(outputSize);
+			if (isBOM)
+			{
+				output += "\xEF\xBB\xBF";
+			}
+			for (auto const& line : lines)
+			{
+				output += line.text;
+				output += line.value;
+				output += line.suffix;
+				output += line.ending;
+			}
+		}
+		[[nodiscard]] bool write(std::filesystem::path const& filename)
+		{
+			std::string contents;
+			render(contents);
+			INIFileStamp stamp;
+			synced = false;
+			if (!INIWriter(filename).writeOutput(contents))
+			{
+				return false;
+			}
+			if (stamp.read(filename))
+			{
+				setSynced(filename, stamp);
+			}
+			return true;
+		}
+		// like write(), but when the file wasn't changed since it was last read
+		// or written only the changed parts are written: lines that kept their
+		// length are overwritten in place and the rest of the file is written
+		// from the first line that moved. The file is not replaced atomically
+		[[nodiscard]] bool patch(std::filesystem::path const& filename)
+		{
+#if defined(__unix__) || defined(__APPLE__)
+			INIFileStamp stamp;
+			if (!synced || isBOM != syncedBOM || filename != syncedFile || !stamp.read(filename) || stamp != syncedStamp)
+			{
+				return write(filename);
+			}
+			const int fd = ::open(filename.c_str(), O_RDWR);
+			if (fd < 0)
+			{
+				return false;
+			}
+			if (!matchesFile(fd))
+			{
+				// changed without changing its size or time
+				::close(fd);
+				return write(filename);
+			}
+			synced = false;
+			const bool success = patchFile(fd);
+			::close(fd);
+			if (success && stamp.read(filename))
+			{
+				setSynced(filename, stamp);
+			}
+			return success;
+#else
+			return write(filename);
+#endif
+		}
+
+		[[nodiscard]] bool has(std::string_view section) const
+		{
+			return sections.count(normalize(section)) == 1;
+		}
+		[[nodiscard]] bool has(std::string_view section, std::string_view key) const
+		{
+			auto it = sections.find(normalize(section));
+			return it != sections.end() && it->second.keys.count(normalize(key)) == 1;
+		}
+		[[nodiscard]] std::string get(std::string_view section, std::string_view key) const
+		{
+			auto it = sections.find(normalize(section));
+			if (it == sections.end())
+			{
+				return std::string();
+			}
+			auto it2 = it->second.keys.find(normalize(key));
+			if (it2 == it->second.keys.end())
+			{
+				return std::string();
+			}
+			return it2->second.back()->value;
+		}
+		void set(std::string_view section, std::string_view key, std::string_view value)
+		{
+			section = INIStringUtil::trimView(section);
+			key = INIStringUtil::trimView(key);
+			const auto name = normalize(section);
+			auto it = sections.find(name);
+			auto& collection = (it != sections.end()) ? it->second : addSection(name, section);
+			setKey(collection, normalize(key), key, value);
+		}
+		bool remove(std::string_view section, std::string_view key)
+		{
+			auto it = sections.find(normalize(section));
+			if (it == sections.end())
+			{
+				return false;
+			}
+			auto it2 = it->second.keys.find(normalize(key));
+			if (it2 == it->second.keys.end())
+			{
+				return false;
+			}
+			eraseKey(it->second, it2);
+			return true;
+		}
+		bool remove(std::string_view section)
+		{
+			auto it = sections.find(normalize(section));
+			if (it == sections.end())
+			{
+				return false;
+			}
+			eraseSection(it);
+			return true;
+		}
+		void clear()
+		{
+			lines.clear();
+			sections.clear();
+			newline = INIStringUtil::endl;
+			isBOM = false;
+		}
+		[[nodiscard]] std::size_t size() const
+		{
+			return sections.size();
+		}
+
+		// structure with the same contents as reading the document would give
+		void copyTo(INIStructure& data) const
+		{
+			INIMap<std::string>* collection = nullptr;
+			for (auto const& line : lines)
+			{
+				if (line.type == T_LineType::LINE_SECTION)
+				{
+					collection = &data[line.section->name];
+				}
+				else if (line.type == T_LineType::LINE_KEY)
+				{
+					(*collection)[line.key] = line.value;
+				}
+			}
+		}
+		// changes the document to match a structure, touching only lines that differ
+		void update(INIStructure const& data)
+		{
+			for (auto const& it : data)
+			{
+				auto section = sections.find(it.first);
+				auto& collection = (section != sections.end()) ? section->second : addSection(it.first, it.first);
+				for (auto const& it2 : it.second)
+				{
+					setKey(collection, it2.first, it2.first, it2.second);
+				}
+			}
+			for (auto it = sections.begin(); it != sections.end(); )
+			{
+				auto const collection = data.findNormalized(it->first);
+				if (collection == nullptr)
+				{
+					auto next = std::next(it);
+					eraseSection(it);
+					it = next;
+					continue;
+				}
+				auto& keys = it->second.keys;
+				for (auto it2 = keys.begin(); it2 != keys.end(); )
+				{
+					auto next = std::next(it2);
+					if (collection->findNormalized(it2->first) == nullptr)
+					{
+						eraseKey(it->second, it2);
+					}
+					it2 = next;
+				}
+				++it;
+			}
+		}
+	};
+}
+
+#endif // MINI_DOCUMENT_H_
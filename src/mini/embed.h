@@ -0,0 +1,278 @@
+/*
+ * The MIT License (MIT)
+ * Copyright (c) 2018 Danijel Durakovic
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+///////////////////////////////////////////////////////////////////////////////
+//
+//  /mINI/ embedded structures
+//  Read-only INI data generated at build time.
+//
+///////////////////////////////////////////////////////////////////////////////
+//
+//  Headers generated by the mini_embed() CMake function define an
+//  INIEmbeddedStructure holding the contents of an INI file in static tables.
+//  Sections and keys are found through a minimal perfect hash computed by
+//  the generator, so a lookup hashes the name once and compares one entry.
+//  The structure exposes the read-only has() / get() surface of INIStructure.
+//
+///////////////////////////////////////////////////////////////////////////////
+//
+//  /* CMakeLists.txt */
+//  mini_embed(myapp INPUT defaults.ini NAME defaults)
+//
+//  /* source */
+//  #include "defaults.ini.h"
+//
+//  std::string_view width = defaults::ini.get("window").get("width");
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef MINI_EMBED_H_
+#define MINI_EMBED_H_
+
+#include <cstdint>
+#include <string_view>
+#include "ini.h"
+
+namespace mINI
+{
+	namespace INIEmbed
+	{
+		// 64-bit hashes, so even large files have no two names with equal hashes
+		constexpr std::uint64_t hashBasis = 14695981039346656037ULL;
+		constexpr std::uint64_t hashPrime = 1099511628211ULL;
+		constexpr std::uint64_t hashGolden = 0x9E3779B97F4A7C15ULL;
+
+		// tables carry their own case sensitivity, so folding does not follow MINI_CASE_SENSITIVE
+		constexpr char foldCase(char c, bool caseSensitive)
+		{
+			return (caseSensitive || c < 'A' || c > 'Z') ? c : static_cast<char>(c - 'A' + 'a');
+		}
+		constexpr std::uint64_t hashName(std::uint64_t seed, std::string_view name, bool caseSensitive)
+		{
+			std::uint64_t hash = hashBasis ^ seed;
+			for (const char c : name)
+			{
+				hash = (hash ^ static_cast<unsigned char>(foldCase(c, caseSensitive))) * hashPrime;
+			}
+			return hash;
+		}
+		constexpr std::uint64_t hashKey(std::uint64_t seed, std::uint32_t sectionIndex, std::string_view key, bool caseSensitive)
+		{
+			return hashName(seed ^ ((sectionIndex + 1ULL) * hashGolden), key, caseSensitive);
+		}
+		// spreads the bits of a name hash, so buckets and slots depend on all of them
+		constexpr std::uint64_t mix(std::uint64_t hash)
+		{
+			hash ^= hash >> 33;
+			hash *= 0xFF51AFD7ED558CCDULL;
+			hash ^= hash >> 33;
+			hash *= 0xC4CEB9FE1A85EC53ULL;
+			hash ^= hash >> 33;
+			return hash;
+		}
+		constexpr std::uint32_t bucket(std::uint64_t hash, std::uint32_t bucketCount)
+		{
+			return static_cast<std::uint32_t>(mix(hash) % bucketCount);
+		}
+		constexpr std::uint32_t slot(std::uint64_t hash, std::uint32_t displacement, std::uint32_t slotCount)
+		{
+			return static_cast<std::uint32_t>(mix(hash ^ ((displacement + 1ULL) * hashGolden)) % slotCount);
+		}
+		constexpr bool namesEqual(std::string_view a, std::string_view b, bool caseSensitive)
+		{
+			if (a.size() != b.size())
+			{
+				return false;
+			}
+			for (std::size_t i = 0; i < a.size(); ++i)
+			{
+				if (foldCase(a[i], caseSensitive) != foldCase(b[i], caseSensitive))
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+	}
+
+	// minimal perfect hash over one kind of entry; a name hash picks a bucket,
+	// and the displacement stored for that bucket picks the slot
+	struct INIEmbeddedIndex
+	{
+		const std::uint32_t* displacements;
+		std::uint32_t bucketCount;
+		// slots hold index + 1 of the entry placed in them, 0 if empty
+		const std::uint32_t* slots;
+		std::uint32_t slotCount;
+
+		constexpr std::uint32_t find(std::uint64_t hash) const
+		{
+			const std::uint32_t displacement = displacements[INIEmbed::bucket(hash, bucketCount)];
+			return slots[INIEmbed::slot(hash, displacement, slotCount)];
+		}
+	};
+
+	struct INIEmbeddedKey
+	{
+		std::string_view key;
+		std::string_view value;
+	};
+
+	struct INIEmbeddedSectionData
+	{
+		std::string_view name;
+		std::uint32_t firstKey;
+		std::uint32_t keyCount;
+	};
+
+	struct INIEmbeddedTables
+	{
+		const INIEmbeddedSectionData* sections;
+		std::uint32_t sectionCount;
+		const INIEmbeddedKey* keys;
+		INIEmbeddedIndex sectionIndex;
+		INIEmbeddedIndex keyIndex;
+		std::uint32_t seed;
+		bool caseSensitive;
+	};
+
+	class INIEmbeddedSection
+	{
+	private:
+		const INIEmbeddedTables* tables;
+		std::uint32_t sectionIndex;
+
+		constexpr const INIEmbeddedKey* find(std::string_view key) const
+		{
+			if (tables == nullptr)
+			{
+				return nullptr;
+			}
+			key = INIStringUtil::trimView(key);
+			auto const& section = tables->sections[sectionIndex];
+			const std::uint64_t hash = INIEmbed::hashKey(tables->seed, sectionIndex, key, tables->caseSensitive);
+			const std::uint32_t slot = tables->keyIndex.find(hash);
+			if (slot == 0U || slot - 1U < section.firstKey || slot - 1U >= section.firstKey + section.keyCount)
+			{
+				return nullptr;
+			}
+			const INIEmbeddedKey* entry = tables->keys + (slot - 1U);
+			return (INIEmbed::namesEqual(entry->key, key, tables->caseSensitive)) ? entry : nullptr;
+		}
+
+	public:
+		using const_iterator = const INIEmbeddedKey*;
+
+		constexpr INIEmbeddedSection(const INIEmbeddedTables* tables = nullptr, std::uint32_t sectionIndex = 0)
+		: tables(tables)
+		, sectionIndex(sectionIndex)
+		{
+		}
+
+		[[nodiscard]] constexpr bool has(std::string_view key) const
+		{
+			return find(key) != nullptr;
+		}
+		[[nodiscard]] constexpr std::string_view get(std::string_view key) const
+		{
+			const INIEmbeddedKey* entry = find(key);
+			return (entry) ? entry->value : std::string_view();
+		}
+		[[nodiscard]] constexpr std::size_t size() const
+		{
+			return (tables) ? tables->sections[sectionIndex].keyCount : 0U;
+		}
+		[[nodiscard]] constexpr const_iterator begin() const
+		{
+			return (tables) ? tables->keys + tables->sections[sectionIndex].firstKey : nullptr;
+		}
+		[[nodiscard]] constexpr const_iterator end() const
+		{
+			return (tables) ? begin() + size() : nullptr;
+		}
+	};
+
+	class INIEmbeddedStructure
+	{
+	private:
+		INIEmbeddedTables tables;
+
+		constexpr std::uint32_t find(std::string_view section) const
+		{
+			section = INIStringUtil::trimView(section);
+			const std::uint64_t hash = INIEmbed::hashName(tables.seed, section, tables.caseSensitive);
+			const std::uint32_t slot = tables.sectionIndex.find(hash);
+			if (slot == 0U || !INIEmbed::namesEqual(tables.sections[slot - 1U].name, section, tables.caseSensitive))
+			{
+				return tables.sectionCount;
+			}
+			return slot - 1U;
+		}
+
+	public:
+		using const_iterator = const INIEmbeddedSectionData*;
+
+		constexpr INIEmbeddedStructure(INIEmbeddedTables const& tables)
+		: tables(tables)
+		{
+		}
+
+		[[nodiscard]] constexpr bool has(std::string_view section) const
+		{
+			return find(section) != tables.sectionCount;
+		}
+		[[nodiscard]] constexpr INIEmbeddedSection get(std::string_view section) const
+		{
+			const std::uint32_t index = find(section);
+			return (index != tables.sectionCount) ? INIEmbeddedSection(&tables, index) : INIEmbeddedSection();
+		}
+		[[nodiscard]] constexpr std::size_t size() const
+		{
+			return tables.sectionCount;
+		}
+		[[nodiscard]] constexpr const_iterator begin() const
+		{
+			return tables.sections;
+		}
+		[[nodiscard]] constexpr const_iterator end() const
+		{
+			return tables.sections + tables.sectionCount;
+		}
+		// adds every section and key to a runtime structure, overriding existing values
+		void copyTo(INIStructure& data) const
+		{
+			for (std::uint32_t i = 0; i < tables.sectionCount; ++i)
+			{
+				auto const& section = tables.sections[i];
+				auto& collection = data[std::string(section.name)];
+				for (std::uint32_t j = 0; j < section.keyCount; ++j)
+				{
+					auto const& entry = tables.keys[section.firstKey + j];
+					collection[std::string(entry.key)] = std::string(entry.value);
+				}
+			}
+		}
+	};
+}
+
+#endif // MINI_EMBED_H_
@@ -84,6 +84,7 @@
 #define MINI_INI_H_
 
 #include <string>
+#include <string_view>
 #include <sstream>
 #include <algorithm>
 #include <utility>
@@ -93,17 +94,38 @@
 #include <fstream>
 #include <cctype>
 #include <filesystem>
+#include <charconv>
+#include <type_traits>
+#include <atomic>
+#include <mutex>
+#include <cstdint>
+#include <chrono>
+#if defined(__unix__) || defined(__APPLE__)
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 namespace mINI
 {
 	namespace INIStringUtil
 	{
-		const char* const whitespaceDelimiters = " \t\n\r\f\v";
+		constexpr const char* whitespaceDelimiters = " \t\n\r\f\v";
 		inline void trim(std::string& str)
 		{
 			str.erase(str.find_last_not_of(whitespaceDelimiters) + 1);
 			str.erase(0, str.find_first_not_of(whitespaceDelimiters));
 		}
+		constexpr std::string_view trimView(std::string_view str)
+		{
+			const auto first = str.find_first_not_of(whitespaceDelimiters);
+			if (first == std::string_view::npos)
+			{
+				return std::string_view();
+			}
+			return str.substr(first, str.find_last_not_of(whitespaceDelimiters) - first + 1);
+		}
 #ifndef MINI_CASE_SENSITIVE
 		inline void toLower(std::string& str)
 		{
@@ -124,6 +146,56 @@ namespace mINI
 				}
 			}
 		}
+		constexpr char foldCase(const char c)
+		{
+#ifndef MINI_CASE_SENSITIVE
+			return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+#else
+			return c;
+#endif
+		}
+		constexpr bool namesEqual(std::string_view a, std::string_view b)
+		{
+			if (a.size() != b.size())
+			{
+				return false;
+			}
+			for (std::size_t i = 0; i < a.size(); ++i)
+			{
+				if (foldCase(a[i]) != foldCase(b[i]))
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+		inline void unescapeKey(std::string& str, std::string_view key)
+		{
+			str.clear();
+			str.reserve(key.size());
+			for (std::size_t i = 0; i < key.size(); ++i)
+			{
+				if (key[i] == '\\' && i + 1 < key.size() && key[i + 1] == '=')
+				{
+					++i;
+				}
+				str += key[i];
+			}
+		}
+		template<typename T>
+		inline void appendNumber(std::string& str, T value)
+		{
+			if constexpr (std::is_same_v<T, bool>)
+			{
+				str += (value) ? "true" : "false";
+			}
+			else
+			{
+				char buffer[64];
+				const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+				str.append(buffer, result.ptr);
+			}
+		}
 #ifdef _WIN32
 		const char* const endl = "\r\n";
 #else
@@ -131,33 +203,243 @@ namespace mINI
 #endif
 	}
 
+	namespace INIGeneration
+	{
+		inline std::atomic<std::size_t>& trackerCount() noexcept
+		{
+			static std::atomic<std::size_t> count{0};
+			return count;
+		}
+		// changes are only stamped while some INIGenerationTracker is started,
+		// so code that doesn't compare generations doesn't pay for them
+		inline bool isTracking() noexcept
+		{
+			return trackerCount().load(std::memory_order_relaxed) != 0;
+		}
+		// every change to any INIMap is stamped with a new, increasing value
+		inline std::uint64_t next() noexcept
+		{
+			static std::atomic<std::uint64_t> counter{0};
+			return counter.fetch_add(1, std::memory_order_relaxed) + 1;
+		}
+	}
+
+	// keeps changes to all maps stamped while started; generations taken
+	// before starting may be out of date, ones taken after are not
+	class INIGenerationTracker
+	{
+	private:
+		bool started = false;
+
+	public:
+		INIGenerationTracker() = default;
+		~INIGenerationTracker()
+		{
+			stop();
+		}
+
+		INIGenerationTracker(INIGenerationTracker const&) = delete;
+		INIGenerationTracker& operator=(INIGenerationTracker const&) = delete;
+
+		void start() noexcept
+		{
+			if (!started)
+			{
+				INIGeneration::trackerCount().fetch_add(1, std::memory_order_relaxed);
+				started = true;
+			}
+		}
+		void stop() noexcept
+		{
+			if (started)
+			{
+				INIGeneration::trackerCount().fetch_sub(1, std::memory_order_relaxed);
+				started = false;
+			}
+		}
+		[[nodiscard]] bool isStarted() const noexcept
+		{
+			return started;
+		}
+	};
+
+#ifdef MINI_TRACE
+	// receives a span around each operation and phase of reading and writing,
+	// on the thread that runs it; mini/trace.h has a sink for Chrome traces
+	class INITraceSink
+	{
+	public:
+		virtual ~INITraceSink() = default;
+		virtual void begin(const char* name) = 0;
+		// size is in bytes, except for lines parsed and entries reindexed
+		virtual void end(const char* name, std::size_t size) = 0;
+	};
+
+	namespace INITrace
+	{
+		inline std::atomic<INITraceSink*>& currentSink() noexcept
+		{
+			static std::atomic<INITraceSink*> sink{nullptr};
+			return sink;
+		}
+		// the sink must outlive any span that started while it was set
+		inline void setSink(INITraceSink* sink) noexcept
+		{
+			currentSink().store(sink, std::memory_order_release);
+		}
+	}
+
+	class INITraceSpan
+	{
+	private:
+		INITraceSink* sink;
+		const char* name;
+
+	public:
+		std::size_t size = 0;
+
+		explicit INITraceSpan(const char* name)
+		: sink(INITrace::currentSink().load(std::memory_order_acquire))
+		, name(name)
+		{
+			if (sink != nullptr)
+			{
+				sink->begin(name);
+			}
+		}
+		~INITraceSpan()
+		{
+			if (sink != nullptr)
+			{
+				sink->end(name, size);
+			}
+		}
+
+		INITraceSpan(INITraceSpan const&) = delete;
+		INITraceSpan& operator=(INITraceSpan const&) = delete;
+	};
+
+#define MINI_TRACE_SPAN(span, name) ::mINI::INITraceSpan span(name)
+#define MINI_TRACE_SIZE(span, value) (span.size = static_cast<std::size_t>(value))
+#else
+#define MINI_TRACE_SPAN(span, name)
+#define MINI_TRACE_SIZE(span, value)
+#endif
+
+	class INIDiff;
+	class INIWriter;
+	class INIDocument;
+	class INIParallelGenerator;
+	class INIJournal;
+
 	template<typename T>
 	class INIMap
 	{
+		friend class INIDiff;
+		friend class INIWriter;
+		friend class INIDocument;
+		friend class INIJournal;
+
 	private:
 		using T_DataIndexMap = std::unordered_map<std::string, std::size_t>;
 		using T_DataItem = std::pair<std::string, T>;
 		using T_DataContainer = std::vector<T_DataItem>;
 		using T_MultiArgs = typename std::vector<std::pair<std::string, T>>;
+		using T_Generations = std::vector<std::uint64_t>;
+
+		template<typename U>
+		static constexpr bool isMap(const INIMap<U>*) { return true; }
+		static constexpr bool isMap(const void*) { return false; }
+		// changes to nested maps are tracked by the nested maps themselves
+		static constexpr bool nestedMaps = isMap(static_cast<const T*>(nullptr));
 
 		T_DataIndexMap dataIndexMap;
 		T_DataContainer data;
+		T_Generations dataGenerations;
+		std::uint64_t lastGeneration = 0;
 
 		std::size_t setEmpty(std::string& key)
 		{
 			const std::size_t index = data.size();
 			dataIndexMap[key] = index;
 			data.emplace_back(key, T());
+			dataGenerations.emplace_back();
 			return index;
 		}
+		void touch(std::size_t index)
+		{
+			if (INIGeneration::isTracking())
+			{
+				lastGeneration = INIGeneration::next();
+				dataGenerations[index] = lastGeneration;
+			}
+		}
+		void touchAll()
+		{
+			if (INIGeneration::isTracking())
+			{
+				lastGeneration = INIGeneration::next();
+				dataGenerations.assign(data.size(), lastGeneration);
+			}
+		}
+		void touchRemoved()
+		{
+			if (INIGeneration::isTracking())
+			{
+				lastGeneration = INIGeneration::next();
+			}
+		}
+		// lookup by a key that is already trimmed and lowercased
+		const T* findNormalized(std::string const& key) const
+		{
+			auto it = dataIndexMap.find(key);
+			return (it != dataIndexMap.end()) ? &data[it->second].second : nullptr;
+		}
 
 	public:
 		using const_iterator = typename T_DataContainer::const_iterator;
 
 		INIMap() = default;
 
-		INIMap(INIMap const& other) : dataIndexMap(other.dataIndexMap), data(other.data)
+		// copies count as new entries only while generations are tracked
+		INIMap(INIMap const& other)
+		: dataIndexMap(other.dataIndexMap)
+		, data(other.data)
+		, dataGenerations(other.dataGenerations)
+		, lastGeneration(other.lastGeneration)
+		{
+			touchAll();
+		}
+		INIMap(INIMap&& other) noexcept
+		: dataIndexMap(std::move(other.dataIndexMap))
+		, data(std::move(other.data))
+		, dataGenerations(std::move(other.dataGenerations))
+		, lastGeneration(other.lastGeneration)
 		{
+			other.clear();
+		}
+		INIMap& operator=(INIMap const& other)
+		{
+			if (this != &other)
+			{
+				dataIndexMap = other.dataIndexMap;
+				data = other.data;
+				dataGenerations = other.dataGenerations;
+				touchAll();
+			}
+			return *this;
+		}
+		INIMap& operator=(INIMap&& other) noexcept
+		{
+			if (this != &other)
+			{
+				dataIndexMap = std::move(other.dataIndexMap);
+				data = std::move(other.data);
+				dataGenerations = std::move(other.dataGenerations);
+				touchAll();
+				other.clear();
+			}
+			return *this;
 		}
 
 		T& operator[](std::string key)
@@ -169,6 +451,10 @@ namespace mINI
 			auto it = dataIndexMap.find(key);
 			const bool hasIt = (it != dataIndexMap.end());
 			const std::size_t index = (hasIt) ? it->second : setEmpty(key);
+			if (!hasIt || !nestedMaps)
+			{
+				touch(index);
+			}
 			return data[index].second;
 		}
 		[[nodiscard]] T get(std::string key) const
@@ -202,13 +488,31 @@ namespace mINI
 			if (it != dataIndexMap.end())
 			{
 				data[it->second].second = obj;
+				touch(it->second);
 			}
 			else
 			{
 				dataIndexMap[key] = data.size();
 				data.emplace_back(key, obj);
+				dataGenerations.emplace_back();
+				touch(data.size() - 1);
 			}
 		}
+		template<typename V, typename U = T>
+		std::enable_if_t<std::is_arithmetic_v<V> && !std::is_same_v<V, char> && std::is_same_v<U, std::string>>
+		set(std::string key, V value)
+		{
+			INIStringUtil::trim(key);
+#ifndef MINI_CASE_SENSITIVE
+			INIStringUtil::toLower(key);
+#endif
+			auto it = dataIndexMap.find(key);
+			const std::size_t index = (it != dataIndexMap.end()) ? it->second : setEmpty(key);
+			auto& str = data[index].second;
+			str.clear();
+			INIStringUtil::appendNumber(str, value);
+			touch(index);
+		}
 		void set(T_MultiArgs const& multiArgs)
 		{
 			for (auto const& it : multiArgs)
@@ -229,7 +533,13 @@ namespace mINI
 			{
 				std::size_t index = it->second;
 				data.erase(data.begin() + index);
+				dataGenerations.erase(dataGenerations.begin() + index);
 				dataIndexMap.erase(it);
+				touchRemoved();
+				// entries after the removed one move down by one, so removing
+				// takes time linear in the size of the map
+				MINI_TRACE_SPAN(span, "reindex");
+				MINI_TRACE_SIZE(span, data.size() - index);
 				for (auto& it2 : dataIndexMap)
 				{
 					auto& vi = it2.second;
@@ -246,20 +556,116 @@ namespace mINI
 		{
 			data.clear();
 			dataIndexMap.clear();
+			dataGenerations.clear();
+			touchRemoved();
 		}
 		[[nodiscard]] std::size_t size() const
 		{
 			return data.size();
 		}
+		// increases whenever this map or a map nested in it is changed
+		[[nodiscard]] std::uint64_t generation() const
+		{
+			std::uint64_t result = lastGeneration;
+			if constexpr (nestedMaps)
+			{
+				for (auto const& it : data)
+				{
+					result = std::max(result, it.second.generation());
+				}
+			}
+			return result;
+		}
 		[[nodiscard]] const_iterator begin() const { return data.begin(); }
 		[[nodiscard]] const_iterator end() const { return data.end(); }
 	};
 
 	using INIStructure = INIMap<INIMap<std::string>>;
 
+	class INIDiff
+	{
+	public:
+		using T_SectionNames = std::vector<std::string>;
+		using T_KeyNames = std::vector<std::pair<std::string, std::string>>;
+
+		T_SectionNames sectionsAdded;
+		T_SectionNames sectionsRemoved;
+		T_SectionNames sectionsChanged;
+		T_KeyNames keysAdded;
+		T_KeyNames keysRemoved;
+		T_KeyNames keysChanged;
+
+		INIDiff(INIStructure const& before, INIStructure const& after)
+		{
+			for (auto const& it : after.data)
+			{
+				auto const& section = it.first;
+				auto const& collection = it.second;
+				const auto collectionBefore = before.findNormalized(section);
+				if (collectionBefore == nullptr)
+				{
+					sectionsAdded.emplace_back(section);
+					continue;
+				}
+				std::size_t added = 0;
+				bool changed = false;
+				for (auto const& it2 : collection.data)
+				{
+					const auto valueBefore = collectionBefore->findNormalized(it2.first);
+					if (valueBefore == nullptr)
+					{
+						keysAdded.emplace_back(section, it2.first);
+						++added;
+					}
+					else if (*valueBefore != it2.second)
+					{
+						keysChanged.emplace_back(section, it2.first);
+						changed = true;
+					}
+				}
+				// only look for removed keys if some old key went unmatched
+				if (collectionBefore->size() + added != collection.size())
+				{
+					for (auto const& it2 : collectionBefore->data)
+					{
+						if (collection.findNormalized(it2.first) == nullptr)
+						{
+							keysRemoved.emplace_back(section, it2.first);
+							changed = true;
+						}
+					}
+				}
+				if (changed || added != 0)
+				{
+					sectionsChanged.emplace_back(section);
+				}
+			}
+			if (before.size() + sectionsAdded.size() != after.size())
+			{
+				for (auto const& it : before.data)
+				{
+					if (after.findNormalized(it.first) == nullptr)
+					{
+						sectionsRemoved.emplace_back(it.first);
+					}
+				}
+			}
+		}
+
+		[[nodiscard]] bool empty() const
+		{
+			return (
+				sectionsAdded.empty() &&
+				sectionsRemoved.empty() &&
+				sectionsChanged.empty()
+			);
+		}
+	};
+
 	namespace INIParser
 	{
 		using T_ParseValues = std::pair<std::string, std::string>;
+		using T_ParseViews = std::pair<std::string_view, std::string_view>;
 
 		enum class PDataType : char
 		{
@@ -270,11 +676,11 @@ namespace mINI
 			PDATA_UNKNOWN
 		};
 
-		inline PDataType parseLine(std::string line, T_ParseValues& parseData)
+		constexpr PDataType parseLine(std::string_view line, T_ParseViews& parseData)
 		{
-			parseData.first.clear();
-			parseData.second.clear();
-			INIStringUtil::trim(line);
+			parseData.first = std::string_view();
+			parseData.second = std::string_view();
+			line = INIStringUtil::trimView(line);
 			if (line.empty())
 			{
 				return PDataType::PDATA_NONE;
@@ -287,37 +693,131 @@ namespace mINI
 			if (firstCharacter == '[')
 			{
 				auto commentAt = line.find_first_of(';');
-				if (commentAt != std::string::npos)
+				if (commentAt != std::string_view::npos)
 				{
 					line = line.substr(0, commentAt);
 				}
 				auto closingBracketAt = line.find_last_of(']');
-				if (closingBracketAt != std::string::npos)
+				if (closingBracketAt != std::string_view::npos)
 				{
-					auto section = line.substr(1, closingBracketAt - 1);
-					INIStringUtil::trim(section);
-					parseData.first = section;
+					parseData.first = INIStringUtil::trimView(line.substr(1, closingBracketAt - 1));
 					return PDataType::PDATA_SECTION;
 				}
 			}
-			auto lineNorm = line;
-			INIStringUtil::replace(lineNorm, "\\=", "  ");
-			auto equalsAt = lineNorm.find_first_of('=');
-			if (equalsAt != std::string::npos)
+			// first '=' that is not part of an escaped "\=" sequence
+			for (std::size_t i = 0; i < line.size(); ++i)
 			{
-				auto key = line.substr(0, equalsAt);
-				INIStringUtil::trim(key);
-				INIStringUtil::replace(key, "\\=", "=");
-				auto value = line.substr(equalsAt + 1);
-				INIStringUtil::trim(value);
-				parseData.first = key;
-				parseData.second = value;
-				return PDataType::PDATA_KEYVALUE;
+				if (line[i] == '\\' && i + 1 < line.size() && line[i + 1] == '=')
+				{
+					++i;
+				}
+				else if (line[i] == '=')
+				{
+					parseData.first = INIStringUtil::trimView(line.substr(0, i));
+					parseData.second = INIStringUtil::trimView(line.substr(i + 1));
+					return PDataType::PDATA_KEYVALUE;
+				}
 			}
 			return PDataType::PDATA_UNKNOWN;
 		}
+
+		inline PDataType parseLine(std::string_view line, T_ParseValues& parseData)
+		{
+			T_ParseViews parseViews;
+			const PDataType parseResult = parseLine(line, parseViews);
+			if (parseResult == PDataType::PDATA_KEYVALUE)
+			{
+				INIStringUtil::unescapeKey(parseData.first, parseViews.first);
+			}
+			else
+			{
+				parseData.first.assign(parseViews.first.data(), parseViews.first.size());
+			}
+			parseData.second.assign(parseViews.second.data(), parseViews.second.size());
+			return parseResult;
+		}
 	}
 
+	// counters filled by INIReader, INIWriter and INIGenerator when given a
+	// pointer to them; counters add up until reset() is called
+	struct INIStats
+	{
+		using T_Clock = std::chrono::steady_clock;
+		using T_Duration = std::chrono::nanoseconds;
+
+		// input and output sizes
+		std::uintmax_t bytesRead = 0;
+		std::uintmax_t bytesWritten = 0;
+		// lines read, or lines generated by INIGenerator
+		std::size_t lines = 0;
+		std::size_t sections = 0;
+		std::size_t keys = 0;
+		std::size_t comments = 0;
+		// lines that are neither empty, comments, sections nor keys
+		std::size_t unknownLines = 0;
+		bool isBOM = false;
+		// heap allocations, counted only if allocationCounter is set; it
+		// should return the number of allocations the process made so far
+		std::uint64_t allocations = 0;
+		std::uint64_t (*allocationCounter)() = nullptr;
+		// time spent per phase
+		T_Duration io { 0 };
+		T_Duration split { 0 };
+		T_Duration parse { 0 };
+		T_Duration insert { 0 };
+		T_Duration format { 0 };
+		T_Duration flush { 0 };
+
+		// adds the time and allocations between construction and destruction
+		// to a phase of stats, if there are any
+		class T_Phase
+		{
+		private:
+			INIStats* stats;
+			T_Duration INIStats::* phase;
+			T_Clock::time_point start;
+			std::uint64_t allocationsAtStart = 0;
+
+		public:
+			T_Phase(INIStats* stats, T_Duration INIStats::* phase)
+			: stats(stats)
+			, phase(phase)
+			{
+				if (stats != nullptr)
+				{
+					allocationsAtStart = stats->countAllocations();
+					start = T_Clock::now();
+				}
+			}
+			~T_Phase()
+			{
+				if (stats != nullptr)
+				{
+					stats->*phase += std::chrono::duration_cast<T_Duration>(T_Clock::now() - start);
+					stats->allocations += stats->countAllocations() - allocationsAtStart;
+				}
+			}
+
+			T_Phase(T_Phase const&) = delete;
+			T_Phase& operator=(T_Phase const&) = delete;
+		};
+
+		[[nodiscard]] std::uint64_t countAllocations() const
+		{
+			return (allocationCounter != nullptr) ? allocationCounter() : 0;
+		}
+		[[nodiscard]] T_Duration total() const
+		{
+			return io + split + parse + insert + format + flush;
+		}
+		void reset()
+		{
+			auto counter = allocationCounter;
+			*this = INIStats();
+			allocationCounter = counter;
+		}
+	};
+
 	class INIReader
 	{
 	public:
@@ -325,46 +825,28 @@ namespace mINI
 		using T_LineDataPtr = std::shared_ptr<T_LineData>;
 
 		bool isBOM = false;
+		// filled in while reading if set
+		INIStats* stats = nullptr;
 
 	private:
+		struct T_StringSource {};
+
 		std::ifstream fileReadStream;
+		std::string_view stringContents;
+		bool readFromString = false;
 		T_LineDataPtr lineData;
 
-		T_LineData readFile()
+		static T_LineData splitLines(std::string_view contents)
 		{
-			fileReadStream.seekg(0, std::ios::end);
-			const std::size_t fileSize = static_cast<std::size_t>(fileReadStream.tellg());
-			fileReadStream.seekg(0, std::ios::beg);
-			if (fileSize >= 3) {
-				const char header[3] = {
-					static_cast<char>(fileReadStream.get()),
-					static_cast<char>(fileReadStream.get()),
-					static_cast<char>(fileReadStream.get())
-				};
-				isBOM = (
-					header[0] == static_cast<char>(0xEF) &&
-					header[1] == static_cast<char>(0xBB) &&
-					header[2] == static_cast<char>(0xBF)
-				);
-			}
-			else {
-				isBOM = false;
-			}
-			std::string fileContents;
-			fileContents.resize(fileSize);
-			fileReadStream.seekg(isBOM ? 3 : 0, std::ios::beg);
-			fileReadStream.read(fileContents.data(), fileSize);
-			fileReadStream.close();
 			T_LineData output;
-			if (fileSize == 0)
+			if (contents.empty())
 			{
 				return output;
 			}
 			std::string buffer;
 			buffer.reserve(50);
-			for (std::size_t i = 0; i < fileSize; ++i)
+			for (const char c : contents)
 			{
-				const char& c = fileContents[i];
 				if (c == '\n')
 				{
 					output.emplace_back(buffer);
@@ -379,39 +861,171 @@ namespace mINI
 			output.emplace_back(buffer);
 			return output;
 		}
-
-	public:
-		INIReader(std::filesystem::path const& filename, bool keepLineData = false)
+		static bool hasBOM(std::string_view contents)
 		{
-			fileReadStream.open(filename, std::ios::in | std::ios::binary);
-			if (keepLineData)
-			{
-				lineData = std::make_shared<T_LineData>();
-			}
+			return (
+				contents.size() >= 3 &&
+				contents[0] == static_cast<char>(0xEF) &&
+				contents[1] == static_cast<char>(0xBB) &&
+				contents[2] == static_cast<char>(0xBF)
+			);
 		}
-		~INIReader() = default;
 
-		bool operator>>(INIStructure& data)
+		T_LineData readFile()
 		{
-			if (!fileReadStream.is_open())
-			{
-				return false;
-			}
-			const T_LineData fileLines = readFile();
-			std::string section;
-			bool inSection = false;
-			INIParser::T_ParseValues parseData;
-			for (auto const& line : fileLines)
+			if (readFromString)
 			{
-				auto parseResult = INIParser::parseLine(line, parseData);
-				if (parseResult == INIParser::PDataType::PDATA_SECTION)
+				isBOM = hasBOM(stringContents);
+				if (stats != nullptr)
 				{
-					inSection = true;
-					data[section = parseData.first];
+					stats->bytesRead += stringContents.size();
+					stats->isBOM = isBOM;
 				}
-				else if (inSection && parseResult == INIParser::PDataType::PDATA_KEYVALUE)
-				{
-					auto const& key = parseData.first;
+				INIStats::T_Phase phase(stats, &INIStats::split);
+				MINI_TRACE_SPAN(span, "split");
+				MINI_TRACE_SIZE(span, stringContents.size());
+				return splitLines(stringContents.substr(isBOM ? 3 : 0));
+			}
+			std::string fileContents;
+			{
+				INIStats::T_Phase phase(stats, &INIStats::io);
+				MINI_TRACE_SPAN(span, "io");
+				readFileContents(fileContents);
+				MINI_TRACE_SIZE(span, fileContents.size());
+			}
+			if (stats != nullptr)
+			{
+				stats->bytesRead += fileContents.size();
+				stats->isBOM = isBOM;
+			}
+			INIStats::T_Phase phase(stats, &INIStats::split);
+			MINI_TRACE_SPAN(span, "split");
+			MINI_TRACE_SIZE(span, fileContents.size());
+			return splitLines(fileContents);
+		}
+		void readFileContents(std::string& fileContents)
+		{
+			fileReadStream.seekg(0, std::ios::end);
+			const std::size_t fileSize = static_cast<std::size_t>(fileReadStream.tellg());
+			fileReadStream.seekg(0, std::ios::beg);
+			if (fileSize >= 3) {
+				const char header[3] = {
+					static_cast<char>(fileReadStream.get()),
+					static_cast<char>(fileReadStream.get()),
+					static_cast<char>(fileReadStream.get())
+				};
+				isBOM = hasBOM(std::string_view(header, 3));
+			}
+			else {
+				isBOM = false;
+			}
+			fileContents.resize(fileSize);
+			fileReadStream.seekg(isBOM ? 3 : 0, std::ios::beg);
+			fileReadStream.read(fileContents.data(), fileSize);
+			fileReadStream.close();
+		}
+		// the loop is compiled once with and once without counting, so
+		// reading without stats doesn't pay for them
+		template<bool T_Stats, typename T_Visitor>
+		bool visitLines(T_Visitor& visitor)
+		{
+			const T_LineData fileLines = readFile();
+			MINI_TRACE_SPAN(span, "parse");
+			MINI_TRACE_SIZE(span, fileLines.size());
+			INIParser::T_ParseValues parseData;
+			[[maybe_unused]] std::uint64_t allocationsAtStart = 0;
+			[[maybe_unused]] INIStats::T_Clock::time_point time;
+			if constexpr (T_Stats)
+			{
+				stats->lines += fileLines.size();
+				allocationsAtStart = stats->countAllocations();
+				time = INIStats::T_Clock::now();
+			}
+			for (auto const& line : fileLines)
+			{
+				auto parseResult = INIParser::parseLine(line, parseData);
+				if constexpr (T_Stats)
+				{
+					const auto parsed = INIStats::T_Clock::now();
+					stats->parse += std::chrono::duration_cast<INIStats::T_Duration>(parsed - time);
+					switch (parseResult)
+					{
+						case INIParser::PDataType::PDATA_COMMENT: ++stats->comments; break;
+						case INIParser::PDataType::PDATA_SECTION: ++stats->sections; break;
+						case INIParser::PDataType::PDATA_KEYVALUE: ++stats->keys; break;
+						case INIParser::PDataType::PDATA_UNKNOWN: ++stats->unknownLines; break;
+						default: break;
+					}
+					visitor(line, parseResult, parseData);
+					time = INIStats::T_Clock::now();
+					stats->insert += std::chrono::duration_cast<INIStats::T_Duration>(time - parsed);
+				}
+				else
+				{
+					visitor(line, parseResult, parseData);
+				}
+			}
+			if constexpr (T_Stats)
+			{
+				stats->allocations += stats->countAllocations() - allocationsAtStart;
+			}
+			return true;
+		}
+
+		INIReader(std::string_view contents, bool keepLineData, T_StringSource)
+		: stringContents(contents)
+		, readFromString(true)
+		{
+			if (keepLineData)
+			{
+				lineData = std::make_shared<T_LineData>();
+			}
+		}
+
+	public:
+		INIReader(std::filesystem::path const& filename, bool keepLineData = false)
+		{
+			fileReadStream.open(filename, std::ios::in | std::ios::binary);
+			if (keepLineData)
+			{
+				lineData = std::make_shared<T_LineData>();
+			}
+		}
+		~INIReader() = default;
+
+		// reads from a string instead of a file; contents must outlive the reader
+		static INIReader fromString(std::string_view contents, bool keepLineData = false)
+		{
+			return INIReader(contents, keepLineData, T_StringSource());
+		}
+
+		template<typename T_Visitor>
+		bool visit(T_Visitor&& visitor)
+		{
+			if (!readFromString && !fileReadStream.is_open())
+			{
+				return false;
+			}
+			MINI_TRACE_SPAN(span, "INIReader::read");
+			if (stats != nullptr)
+			{
+				return visitLines<true>(visitor);
+			}
+			return visitLines<false>(visitor);
+		}
+		bool operator>>(INIStructure& data)
+		{
+			std::string section;
+			bool inSection = false;
+			return visit([&](std::string const& line, INIParser::PDataType parseResult, INIParser::T_ParseValues const& parseData) {
+				if (parseResult == INIParser::PDataType::PDATA_SECTION)
+				{
+					inSection = true;
+					data[section = parseData.first];
+				}
+				else if (inSection && parseResult == INIParser::PDataType::PDATA_KEYVALUE)
+				{
+					auto const& key = parseData.first;
 					auto const& value = parseData.second;
 					data[section][key] = value;
 				}
@@ -419,12 +1033,11 @@ namespace mINI
 				{
 					if (parseResult == INIParser::PDataType::PDATA_KEYVALUE && !inSection)
 					{
-						continue;
+						return;
 					}
 					lineData->emplace_back(line);
 				}
-			}
-			return true;
+			});
 		}
 		T_LineDataPtr getLines()
 		{
@@ -434,12 +1047,109 @@ namespace mINI
 
 	class INIGenerator
 	{
+		friend class INIParallelGenerator;
+
 	private:
 		std::ofstream fileWriteStream;
 
+		static char* append(char* output, std::string_view str)
+		{
+			return std::copy(str.begin(), str.end(), output);
+		}
+		std::size_t getSeparatorSize() const
+		{
+			const std::size_t endlSize = std::char_traits<char>::length(INIStringUtil::endl);
+			return (prettyPrint) ? endlSize * 2 : endlSize;
+		}
+		std::size_t getSectionSize(std::string const& section, INIMap<std::string> const& collection) const
+		{
+			const std::size_t lineSize = std::char_traits<char>::length(INIStringUtil::endl) + ((prettyPrint) ? 3 : 1);
+			std::size_t size = section.size() + 2;
+			for (auto const& it : collection)
+			{
+				auto const& key = it.first;
+				size += lineSize + key.size() + static_cast<std::size_t>(std::count(key.begin(), key.end(), '='));
+				size += INIStringUtil::trimView(it.second).size();
+			}
+			return size;
+		}
+		char* renderSection(char* output, std::string const& section, INIMap<std::string> const& collection) const
+		{
+			*output++ = '[';
+			output = append(output, section);
+			*output++ = ']';
+			for (auto const& it : collection)
+			{
+				output = append(output, INIStringUtil::endl);
+				for (const char c : it.first)
+				{
+					if (c == '=')
+					{
+						*output++ = '\\';
+					}
+					*output++ = c;
+				}
+				output = append(output, (prettyPrint) ? " = " : "=");
+				output = append(output, INIStringUtil::trimView(it.second));
+			}
+			return output;
+		}
+		std::size_t getOutputSize(INIStructure const& data) const
+		{
+			if (data.size() == 0U)
+			{
+				return 0;
+			}
+			std::size_t size = (data.size() - 1) * getSeparatorSize();
+			for (auto const& it : data)
+			{
+				size += getSectionSize(it.first, it.second);
+			}
+			return size;
+		}
+		char* render(char* output, INIStructure const& data) const
+		{
+			for (auto it = data.begin(); it != data.end(); ++it)
+			{
+				if (it != data.begin())
+				{
+					output = append(output, INIStringUtil::endl);
+					if (prettyPrint)
+					{
+						output = append(output, INIStringUtil::endl);
+					}
+				}
+				output = renderSection(output, it->first, it->second);
+			}
+			return output;
+		}
+		void addStats(INIStructure const& data) const
+		{
+			if (stats == nullptr)
+			{
+				return;
+			}
+			const std::size_t sections = data.size();
+			std::size_t keys = 0;
+			for (auto const& it : data)
+			{
+				keys += it.second.size();
+			}
+			stats->sections += sections;
+			stats->keys += keys;
+			stats->lines += sections + keys + ((prettyPrint && sections != 0) ? sections - 1 : 0);
+			stats->bytesWritten += outputSize;
+		}
+
 	public:
 		bool prettyPrint = false;
+		// size of the last generated output, or the size needed if a buffer was too small
+		std::size_t outputSize = 0;
+		// filled in while generating if set
+		INIStats* stats = nullptr;
 
+		// generates to memory only
+		INIGenerator() = default;
 		INIGenerator(std::filesystem::path const& filename)
 		{
 			fileWriteStream.open(filename, std::ios::out | std::ios::binary);
@@ -452,50 +1162,48 @@ namespace mINI
 			{
 				return false;
 			}
-			if (data.size() == 0U)
+			MINI_TRACE_SPAN(span, "INIGenerator::generate");
+			return generate(data, fileWriteStream);
+		}
+		bool generate(INIStructure const& data, std::string& output)
+		{
 			{
-				return true;
+				INIStats::T_Phase phase(stats, &INIStats::format);
+				MINI_TRACE_SPAN(span, "format");
+				outputSize = getOutputSize(data);
+				MINI_TRACE_SIZE(span, outputSize);
+				output.resize(outputSize);
+				render(output.data(), data);
 			}
-			auto it = data.begin();
-			for (;;)
+			addStats(data);
+			return true;
+		}
+		bool generate(INIStructure const& data, std::ostream& stream)
+		{
+			// the output is sized up front and handed to the stream in one piece
+			std::string output;
+			generate(data, output);
+			INIStats::T_Phase phase(stats, &INIStats::flush);
+			MINI_TRACE_SPAN(span, "flush");
+			MINI_TRACE_SIZE(span, output.size());
+			stream.write(output.data(), static_cast<std::streamsize>(output.size()));
+			stream.flush();
+			return stream.good();
+		}
+		bool generate(INIStructure const& data, char* buffer, std::size_t bufferSize)
+		{
 			{
-				auto const& section = it->first;
-				auto const& collection = it->second;
-				fileWriteStream
-					<< "["
-					<< section
-					<< "]";
-				if (collection.size() != 0U)
-				{
-					fileWriteStream << INIStringUtil::endl;
-					auto it2 = collection.begin();
-					for (;;)
-					{
-						auto key = it2->first;
-						INIStringUtil::replace(key, "=", "\\=");
-						auto value = it2->second;
-						INIStringUtil::trim(value);
-						fileWriteStream
-							<< key
-							<< ((prettyPrint) ? " = " : "=")
-							<< value;
-						if (++it2 == collection.end())
-						{
-							break;
-						}
-						fileWriteStream << INIStringUtil::endl;
-					}
-				}
-				if (++it == data.end())
+				INIStats::T_Phase phase(stats, &INIStats::format);
+				MINI_TRACE_SPAN(span, "format");
+				outputSize = getOutputSize(data);
+				MINI_TRACE_SIZE(span, outputSize);
+				if (outputSize > bufferSize)
 				{
-					break;
-				}
-				fileWriteStream << INIStringUtil::endl;
-				if (prettyPrint)
-				{
-					fileWriteStream << INIStringUtil::endl;
+					return false;
 				}
+				render(buffer, data);
 			}
+			addStats(data);
 			return true;
 		}
 	};
@@ -508,139 +1216,177 @@ namespace mINI
 
 		std::filesystem::path filename;
 
-		T_LineData getLazyOutput(T_LineDataPtr const& lineData, INIStructure& data, INIStructure& original) const
+		using T_Collection = INIMap<std::string>;
+
+		std::string getKeyValueLine(std::string const& key, std::string const& value) const
+		{
+			const auto valueView = INIStringUtil::trimView(value);
+			std::string line;
+			line.reserve(key.size() + valueView.size() + 3);
+			for (const char c : key)
+			{
+				if (c == '=')
+				{
+					line += '\\';
+				}
+				line += c;
+			}
+			line += (prettyPrint) ? " = " : "=";
+			line += valueView;
+			return line;
+		}
+		std::string getUpdatedLine(std::string const& line, std::string const& value) const
+		{
+			// keep everything up to the old value; escaped "\=" sequences are
+			// skipped while looking for the separator and the start of the value
+			const std::string_view whitespace(INIStringUtil::whitespaceDelimiters);
+			std::size_t equalsAt = std::string::npos;
+			std::size_t valueAt = std::string::npos;
+			for (std::size_t i = 0; i < line.size(); ++i)
+			{
+				if (line[i] == '\\' && i + 1 < line.size() && line[i + 1] == '=')
+				{
+					++i;
+				}
+				else if (equalsAt == std::string::npos)
+				{
+					if (line[i] == '=')
+					{
+						equalsAt = i;
+					}
+				}
+				else if (whitespace.find(line[i]) == std::string_view::npos)
+				{
+					valueAt = i;
+					break;
+				}
+			}
+			std::string outputLine = line.substr(0, valueAt);
+			if (prettyPrint && equalsAt + 1 == valueAt)
+			{
+				outputLine += " ";
+			}
+			outputLine += INIStringUtil::trimView(value);
+			return outputLine;
+		}
+		void addNewKeys(T_LineData& output, const T_Collection* collection, const T_Collection* collectionOriginal) const
+		{
+			const bool tracked = (syncedGeneration != 0);
+			if (collection == nullptr || collectionOriginal == nullptr || (tracked && collection->lastGeneration <= syncedGeneration))
+			{
+				return;
+			}
+			for (std::size_t i = 0; i < collection->data.size(); ++i)
+			{
+				// keys untouched since the last sync are already in the file
+				if (tracked && collection->dataGenerations[i] <= syncedGeneration)
+				{
+					continue;
+				}
+				auto const& it = collection->data[i];
+				if (collectionOriginal->findNormalized(it.first) == nullptr)
+				{
+					output.emplace_back(getKeyValueLine(it.first, it.second));
+				}
+			}
+		}
+		T_LineData getLazyOutput(T_LineDataPtr const& lineData, INIStructure const& data, INIStructure const& original) const
 		{
 			T_LineData output;
+			output.reserve(lineData->size());
+			// lines following the last key of the current section; keys new to
+			// the section are written before them once the section ends
+			T_LineData pending;
+			auto flushPending = [&output, &pending]() {
+				for (auto& line : pending)
+				{
+					output.emplace_back(std::move(line));
+				}
+				pending.clear();
+			};
 			INIParser::T_ParseValues parseData;
-			std::string sectionCurrent;
+			const T_Collection* collection = data.findNormalized(std::string());
+			const T_Collection* collectionOriginal = original.findNormalized(std::string());
 			bool parsingSection = false;
 			bool continueToNextSection = false;
 			bool discardNextEmpty = false;
-			bool writeNewKeys = false;
-			std::size_t lastKeyLine = 0;
-			for (auto line = lineData->begin(); line != lineData->end(); ++line)
+			for (auto const& line : *lineData)
 			{
-				if (!writeNewKeys)
+				auto parseResult = INIParser::parseLine(line, parseData);
+				if (parseResult == INIParser::PDataType::PDATA_SECTION)
 				{
-					auto parseResult = INIParser::parseLine(*line, parseData);
-					if (parseResult == INIParser::PDataType::PDATA_SECTION)
+					if (parsingSection)
 					{
-						if (parsingSection)
-						{
-							writeNewKeys = true;
-							parsingSection = false;
-							--line;
-							continue;
-						}
-						sectionCurrent = parseData.first;
-						if (data.has(sectionCurrent))
-						{
-							parsingSection = true;
-							continueToNextSection = false;
-							discardNextEmpty = false;
-							output.emplace_back(*line);
-							lastKeyLine = output.size();
-						}
-						else
-						{
-							continueToNextSection = true;
-							discardNextEmpty = true;
-							continue;
-						}
+						addNewKeys(output, collection, collectionOriginal);
+						flushPending();
+						parsingSection = false;
 					}
-					else if (parseResult == INIParser::PDataType::PDATA_KEYVALUE)
+					auto& section = parseData.first;
+#ifndef MINI_CASE_SENSITIVE
+					INIStringUtil::toLower(section);
+#endif
+					collection = data.findNormalized(section);
+					collectionOriginal = original.findNormalized(section);
+					if (collection != nullptr)
 					{
-						if (continueToNextSection)
-						{
-							continue;
-						}
-						if (data.has(sectionCurrent))
-						{
-							auto& collection = data[sectionCurrent];
-							auto const& key = parseData.first;
-							auto const& value = parseData.second;
-							if (collection.has(key))
-							{
-								auto outputValue = collection[key];
-								if (value == outputValue)
-								{
-									output.emplace_back(*line);
-								}
-								else
-								{
-									INIStringUtil::trim(outputValue);
-									auto lineNorm = *line;
-									INIStringUtil::replace(lineNorm, "\\=", "  ");
-									auto equalsAt = lineNorm.find_first_of('=');
-									auto valueAt = lineNorm.find_first_not_of(
-										INIStringUtil::whitespaceDelimiters,
-										equalsAt + 1
-									);
-									std::string outputLine = line->substr(0, valueAt);
-									if (prettyPrint && equalsAt + 1 == valueAt)
-									{
-										outputLine += " ";
-									}
-									outputLine += outputValue;
-									output.emplace_back(outputLine);
-								}
-								lastKeyLine = output.size();
-							}
-						}
+						parsingSection = true;
+						continueToNextSection = false;
+						discardNextEmpty = false;
+						flushPending();
+						output.emplace_back(line);
 					}
 					else
 					{
-						if (discardNextEmpty && line->empty())
-						{
-							discardNextEmpty = false;
-						}
-						else if (parseResult != INIParser::PDataType::PDATA_UNKNOWN)
-						{
-							output.emplace_back(*line);
-						}
+						continueToNextSection = true;
+						discardNextEmpty = true;
 					}
 				}
-				if (writeNewKeys || std::next(line) == lineData->end())
+				else if (parseResult == INIParser::PDataType::PDATA_KEYVALUE)
 				{
-					T_LineData linesToAdd;
-					if (data.has(sectionCurrent) && original.has(sectionCurrent))
+					if (continueToNextSection || collection == nullptr)
 					{
-						auto const& collection = data[sectionCurrent];
-						auto const& collectionOriginal = original[sectionCurrent];
-						for (auto const& it : collection)
-						{
-							auto key = it.first;
-							if (collectionOriginal.has(key))
-							{
-								continue;
-							}
-							auto value = it.second;
-							INIStringUtil::replace(key, "=", "\\=");
-							INIStringUtil::trim(value);
-							linesToAdd.emplace_back(
-								key + ((prettyPrint) ? " = " : "=") + value
-							);
-						}
+						continue;
 					}
-					if (!linesToAdd.empty())
+					auto& key = parseData.first;
+#ifndef MINI_CASE_SENSITIVE
+					INIStringUtil::toLower(key);
+#endif
+					const auto outputValue = collection->findNormalized(key);
+					if (outputValue == nullptr)
 					{
-						output.insert(
-							output.begin() + lastKeyLine,
-							linesToAdd.begin(),
-							linesToAdd.end()
-						);
+						continue;
 					}
-					if (writeNewKeys)
+					flushPending();
+					if (parseData.second == *outputValue)
 					{
-						writeNewKeys = false;
-						--line;
+						output.emplace_back(line);
+					}
+					else
+					{
+						output.emplace_back(getUpdatedLine(line, *outputValue));
 					}
 				}
+				else
+				{
+					if (discardNextEmpty && line.empty())
+					{
+						discardNextEmpty = false;
+					}
+					else if (parseResult != INIParser::PDataType::PDATA_UNKNOWN)
+					{
+						pending.emplace_back(line);
+					}
+				}
+			}
+			if (!lineData->empty())
+			{
+				addNewKeys(output, collection, collectionOriginal);
 			}
+			flushPending();
 			for (auto const& it : data)
 			{
 				auto const& section = it.first;
-				if (original.has(section))
+				if (original.findNormalized(section) != nullptr)
 				{
 					continue;
 				}
@@ -649,24 +1395,162 @@ namespace mINI
 					output.emplace_back();
 				}
 				output.emplace_back("[" + section + "]");
-				auto const& collection = it.second;
-				for (auto const& it2 : collection)
+				for (auto const& it2 : it.second)
 				{
-					auto key = it2.first;
-					auto value = it2.second;
-					INIStringUtil::replace(key, "=", "\\=");
-					INIStringUtil::trim(value);
-					output.emplace_back(
-						key + ((prettyPrint) ? " = " : "=") + value
-					);
+					output.emplace_back(getKeyValueLine(it2.first, it2.second));
 				}
 			}
 			return output;
 		}
 
+#if defined(__unix__) || defined(__APPLE__)
+		// writes contents to a temporary file next to the original, syncs it
+		// and renames it over the original; a symlink is followed and the
+		// file it points to is replaced. The original's owner and mode are
+		// applied if it exists
+		bool writeAtomic(std::string_view contents, struct stat const* fileStat) const
+		{
+			INIStats::T_Phase phase(stats, &INIStats::flush);
+			MINI_TRACE_SPAN(span, "flush");
+			MINI_TRACE_SIZE(span, contents.size());
+			const auto target = resolveSymlinks(filename);
+			std::filesystem::path tempFilename;
+			const int fd = openTempFile(target, tempFilename);
+			if (fd < 0)
+			{
+				return false;
+			}
+			bool success = (fileStat == nullptr || copyAttributes(fd, *fileStat));
+			const std::size_t contentsSize = contents.size();
+			while (success && !contents.empty())
+			{
+				const auto written = ::write(fd, contents.data(), contents.size());
+				success = (written >= 0);
+				if (success)
+				{
+					contents.remove_prefix(static_cast<std::size_t>(written));
+				}
+			}
+#ifdef __APPLE__
+			success = success && ::fsync(fd) == 0;
+#else
+			success = success && ::fdatasync(fd) == 0;
+#endif
+			success = (::close(fd) == 0) && success;
+			if (!success || ::rename(tempFilename.c_str(), target.c_str()) != 0)
+			{
+				::unlink(tempFilename.c_str());
+				return false;
+			}
+			syncDirectory(target);
+			addBytesWritten(contentsSize);
+			return true;
+		}
+		// reads, updates and replaces the file with a single open of the original
+		bool writeAtomic(INIStructure const& data) const
+		{
+			std::string contents;
+			const int fd = ::open(filename.c_str(), O_RDONLY);
+			if (fd < 0)
+			{
+				if (errno != ENOENT)
+				{
+					return false;
+				}
+				INIGenerator generator;
+				generator.prettyPrint = prettyPrint;
+				generator.stats = stats;
+				generator.generate(data, contents);
+				return writeAtomic(contents, nullptr);
+			}
+			struct stat fileStat;
+			bool success = (::fstat(fd, &fileStat) == 0);
+			if (success)
+			{
+				INIStats::T_Phase phase(stats, &INIStats::io);
+				MINI_TRACE_SPAN(span, "io");
+				MINI_TRACE_SIZE(span, fileStat.st_size);
+				contents.resize(static_cast<std::size_t>(fileStat.st_size));
+				std::size_t position = 0;
+				while (position < contents.size())
+				{
+					const auto count = ::read(fd, contents.data() + position, contents.size() - position);
+					if (count <= 0)
+					{
+						success = (count == 0);
+						break;
+					}
+					position += static_cast<std::size_t>(count);
+				}
+				contents.resize(position);
+			}
+			::close(fd);
+			return (
+				success &&
+				update(contents, data) &&
+				writeAtomic(contents, &fileStat)
+			);
+		}
+#else
+		bool writeAtomic(std::string_view contents) const
+		{
+			INIStats::T_Phase phase(stats, &INIStats::flush);
+			MINI_TRACE_SPAN(span, "flush");
+			MINI_TRACE_SIZE(span, contents.size());
+			const auto target = resolveSymlinks(filename);
+			std::filesystem::path tempFilename;
+			std::error_code ec;
+			do
+			{
+				tempFilename = getTempFilename(target);
+			} while (std::filesystem::exists(tempFilename, ec));
+			{
+				std::ofstream fileWriteStream(tempFilename, std::ios::out | std::ios::binary);
+				fileWriteStream.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+				fileWriteStream.close();
+				if (fileWriteStream.fail())
+				{
+					std::error_code ec;
+					std::filesystem::remove(tempFilename, ec);
+					return false;
+				}
+			}
+			const auto status = std::filesystem::status(target, ec);
+			if (!ec && std::filesystem::exists(status))
+			{
+				std::filesystem::permissions(tempFilename, status.permissions(), ec);
+			}
+			std::filesystem::rename(tempFilename, target, ec);
+			if (ec)
+			{
+				std::filesystem::remove(tempFilename, ec);
+				return false;
+			}
+			addBytesWritten(contents.size());
+			return true;
+		}
+#endif
+		void addBytesWritten(std::size_t size) const
+		{
+			if (stats != nullptr)
+			{
+				stats->bytesWritten += size;
+			}
+		}
+
 	public:
 		bool prettyPrint = false;
+		// replace the file through a temporary file in the same directory
+		// instead of overwriting it, so it is never left half-written
+		bool atomicWrite = false;
+		// generation at which the structure last matched the file, if known;
+		// changes since then must have been tracked by an INIGenerationTracker
+		std::uint64_t syncedGeneration = 0;
+		// filled in while writing if set
+		INIStats* stats = nullptr;
 
+		// updates contents in memory only
+		INIWriter() = default;
 		INIWriter(std::filesystem::path filename)
 		: filename(std::move(filename))
 		{
@@ -675,10 +1559,27 @@ namespace mINI
 
 		bool operator<<(INIStructure& data)
 		{
+			MINI_TRACE_SPAN(span, "INIWriter::write");
+#if defined(__unix__) || defined(__APPLE__)
+			if (atomicWrite)
+			{
+				return writeAtomic(data);
+			}
+#endif
 			if (!std::filesystem::exists(filename))
 			{
+				if (atomicWrite)
+				{
+					std::string contents;
+					INIGenerator generator;
+					generator.prettyPrint = prettyPrint;
+					generator.stats = stats;
+					generator.generate(data, contents);
+					return writeOutput(contents);
+				}
 				INIGenerator generator(filename);
 				generator.prettyPrint = prettyPrint;
+				generator.stats = stats;
 				return generator << data;
 			}
 			INIStructure originalData;
@@ -687,6 +1588,7 @@ namespace mINI
 			bool fileIsBOM = false;
 			{
 				INIReader reader(filename, true);
+				reader.stats = stats;
 				readSuccess = reader >> originalData;
 				if (readSuccess)
 				{
@@ -698,81 +1600,485 @@ namespace mINI
 			{
 				return false;
 			}
-			T_LineData output = getLazyOutput(lineData, data, originalData);
+			return writeOutput(getOutput(data, lineData, originalData, fileIsBOM));
+		}
+		// file contents for data written over the given lines and structure read from the file
+		std::string getOutput(INIStructure const& data, T_LineDataPtr const& lineData, INIStructure const& original, bool fileIsBOM) const
+		{
+			T_LineDataPtr outputLines;
+			return getOutput(data, lineData, original, fileIsBOM, outputLines);
+		}
+		// same as above, also handing out the lines the contents are made of
+		std::string getOutput(INIStructure const& data, T_LineDataPtr const& lineData, INIStructure const& original, bool fileIsBOM, T_LineDataPtr& outputLines) const
+		{
+			INIStats::T_Phase phase(stats, &INIStats::format);
+			MINI_TRACE_SPAN(span, "format");
+			outputLines = std::make_shared<T_LineData>(getLazyOutput(lineData, data, original));
+			auto const& output = *outputLines;
+			std::size_t outputSize = (fileIsBOM) ? 3 : 0;
+			for (auto const& line : output)
+			{
+				outputSize += line.size() + 2;
+			}
+			std::string contents;
+			contents.reserve(outputSize);
+			if (fileIsBOM)
+			{
+				contents += "\xEF\xBB\xBF";
+			}
+			for (auto line = output.begin(); line != output.end(); ++line)
+			{
+				if (line != output.begin())
+				{
+					contents += INIStringUtil::endl;
+				}
+				contents += *line;
+			}
+			MINI_TRACE_SIZE(span, contents.size());
+			return contents;
+		}
+		// same as operator<<, for INI file contents held in memory
+		bool update(std::string& contents, INIStructure const& data) const
+		{
+			MINI_TRACE_SPAN(span, "INIWriter::update");
+			INIStructure original;
+			auto reader = INIReader::fromString(contents, true);
+			reader.stats = stats;
+			if (!(reader >> original))
+			{
+				return false;
+			}
+			contents = getOutput(data, reader.getLines(), original, reader.isBOM);
+			return true;
+		}
+		bool writeOutput(std::string const& contents) const
+		{
+			if (atomicWrite)
+			{
+#if defined(__unix__) || defined(__APPLE__)
+				struct stat fileStat;
+				const bool exists = (::stat(filename.c_str(), &fileStat) == 0);
+				return writeAtomic(contents, (exists) ? &fileStat : nullptr);
+#else
+				return writeAtomic(contents);
+#endif
+			}
+			INIStats::T_Phase phase(stats, &INIStats::flush);
+			MINI_TRACE_SPAN(span, "flush");
+			MINI_TRACE_SIZE(span, contents.size());
 			std::ofstream fileWriteStream(filename, std::ios::out | std::ios::binary);
 			if (fileWriteStream.is_open())
 			{
-				if (fileIsBOM) {
-					const char utf8_BOM[3] = {
-						static_cast<char>(0xEF),
-						static_cast<char>(0xBB),
-						static_cast<char>(0xBF)
-					};
-					fileWriteStream.write(utf8_BOM, 3);
-				}
-				if (!output.empty())
+				fileWriteStream.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+				fileWriteStream.close();
+				if (fileWriteStream.good())
 				{
-					auto line = output.begin();
-					for (;;)
-					{
-						fileWriteStream << *line;
-						if (++line == output.end())
-						{
-							break;
-						}
-						fileWriteStream << INIStringUtil::endl;
-					}
+					addBytesWritten(contents.size());
+					return true;
 				}
-				return true;
 			}
 			return false;
 		}
+		// name for a temporary file next to the given one; every call gives
+		// a new name, so writers in other threads or processes never share one
+		static std::filesystem::path getTempFilename(std::filesystem::path const& filename)
+		{
+			static std::atomic<std::uint64_t> counter { 0 };
+#if defined(__unix__) || defined(__APPLE__)
+			static const auto processId = static_cast<std::uint64_t>(::getpid());
+#else
+			static const auto processId = static_cast<std::uint64_t>(std::chrono::system_clock::now().time_since_epoch().count());
+#endif
+			std::filesystem::path tempFilename = filename;
+			tempFilename += ".tmp." + std::to_string(processId) + "." + std::to_string(counter++);
+			return tempFilename;
+		}
+		// the file a path refers to once symlinks are followed, so replacing
+		// it leaves the links in place; paths that can't be resolved, such as
+		// symlink loops, are returned as they are
+		static std::filesystem::path resolveSymlinks(std::filesystem::path const& filename)
+		{
+			std::filesystem::path target = filename;
+			for (int depth = 0; depth < 40; ++depth)
+			{
+				std::error_code ec;
+				const auto status = std::filesystem::symlink_status(target, ec);
+				if (ec || !std::filesystem::is_symlink(status))
+				{
+					return target;
+				}
+				const auto link = std::filesystem::read_symlink(target, ec);
+				if (ec)
+				{
+					return filename;
+				}
+				target = (link.is_absolute()) ? link : target.parent_path() / link;
+			}
+			return filename;
+		}
+#if defined(__unix__) || defined(__APPLE__)
+		// gives a new file the owner, group and mode of the file it replaces;
+		// without the privileges to change the owner, only the group is kept
+		// if it can be, and the file is owned by the writing process otherwise
+		static bool copyAttributes(int fd, struct stat const& fileStat)
+		{
+			if (::fchown(fd, fileStat.st_uid, fileStat.st_gid) != 0)
+			{
+				[[maybe_unused]] const int grouped = ::fchown(fd, static_cast<uid_t>(-1), fileStat.st_gid);
+			}
+			return ::fchmod(fd, fileStat.st_mode & 07777) == 0;
+		}
+		// creates a temporary file next to the given one and returns its
+		// descriptor; O_EXCL makes sure no existing file is ever opened
+		static int openTempFile(std::filesystem::path const& filename, std::filesystem::path& tempFilename)
+		{
+			for (int attempt = 0; attempt < 100; ++attempt)
+			{
+				tempFilename = getTempFilename(filename);
+				const int fd = ::open(tempFilename.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0666);
+				if (fd >= 0 || errno != EEXIST)
+				{
+					return fd;
+				}
+			}
+			return -1;
+		}
+		// a rename is only durable once the directory holding the file is synced
+		static void syncDirectory(std::filesystem::path const& filename)
+		{
+			const auto directory = filename.parent_path();
+			const int fd = ::open((directory.empty()) ? "." : directory.c_str(), O_RDONLY | O_CLOEXEC);
+			if (fd >= 0)
+			{
+				::fsync(fd);
+				::close(fd);
+			}
+		}
+#endif
+	};
+
+	// identifies a version of a file by its size, modification time and inode
+	struct INIFileStamp
+	{
+		std::uintmax_t size = 0;
+		std::int64_t time = 0;
+		std::uintmax_t device = 0;
+		std::uintmax_t inode = 0;
+
+		bool operator==(INIFileStamp const& other) const
+		{
+			return (
+				size == other.size &&
+				time == other.time &&
+				device == other.device &&
+				inode == other.inode
+			);
+		}
+		bool operator!=(INIFileStamp const& other) const
+		{
+			return !(*this == other);
+		}
+		bool read(std::filesystem::path const& filename)
+		{
+#if defined(__unix__) || defined(__APPLE__)
+			struct stat fileStat;
+			if (::stat(filename.c_str(), &fileStat) != 0)
+			{
+				return false;
+			}
+			size = static_cast<std::uintmax_t>(fileStat.st_size);
+#ifdef __APPLE__
+			auto const& mtime = fileStat.st_mtimespec;
+#else
+			auto const& mtime = fileStat.st_mtim;
+#endif
+			time = static_cast<std::int64_t>(mtime.tv_sec) * 1000000000 + mtime.tv_nsec;
+			device = static_cast<std::uintmax_t>(fileStat.st_dev);
+			inode = static_cast<std::uintmax_t>(fileStat.st_ino);
+			return true;
+#else
+			std::error_code ec;
+			size = std::filesystem::file_size(filename, ec);
+			if (ec)
+			{
+				return false;
+			}
+			const auto writeTime = std::filesystem::last_write_time(filename, ec);
+			time = std::chrono::duration_cast<std::chrono::nanoseconds>(writeTime.time_since_epoch()).count();
+			return !ec;
+#endif
+		}
 	};
 
 	class INIFile
 	{
 	private:
+		struct T_FileState
+		{
+			// file as it was after the last read, generate or write
+			INIFileStamp stamp;
+			bool valid = false;
+			// structure that matched the file at that point, and its generation
+			// if changes are tracked for skipUnchanged
+			const INIStructure* data = nullptr;
+			INIGenerationTracker tracker;
+			std::uint64_t generation = 0;
+			// lines of the file and the structure they hold
+			INIReader::T_LineDataPtr lineData;
+			INIStructure original;
+			bool isBOM = false;
+		};
+
 		std::filesystem::path filename;
+		// read(), generate() and write() are const, so the state they keep
+		// is guarded for files shared between threads; it is only kept while
+		// cacheContents or skipUnchanged need it
+		mutable T_FileState state;
+		mutable std::mutex stateMutex;
+		mutable std::atomic<bool> hasState{false};
+
+		bool keepsState() const
+		{
+			return cacheContents || skipUnchanged;
+		}
+		// drops state kept before both options were turned off
+		void dropState() const
+		{
+			if (hasState.load(std::memory_order_acquire))
+			{
+				std::lock_guard<std::mutex> lock(stateMutex);
+				forget();
+			}
+		}
+		void forget() const
+		{
+			hasState.store(false, std::memory_order_release);
+			state.valid = false;
+			state.data = nullptr;
+			state.tracker.stop();
+			state.lineData.reset();
+			state.original.clear();
+		}
+		bool setSynced(INIStructure const& data, bool success) const
+		{
+			if (!success || !state.stamp.read(filename))
+			{
+				forget();
+				return success;
+			}
+			state.valid = true;
+			state.data = &data;
+			track(data);
+			hasState.store(true, std::memory_order_release);
+			return true;
+		}
+		void track(INIStructure const& data) const
+		{
+			if (skipUnchanged)
+			{
+				state.tracker.start();
+				state.generation = data.generation();
+			}
+		}
+		bool generateFile(INIStructure const& data, bool pretty) const
+		{
+			if (filename.empty())
+			{
+				return false;
+			}
+			if (atomicWrite)
+			{
+				std::string contents;
+				INIGenerator generator;
+				generator.prettyPrint = pretty;
+				generator.stats = stats;
+				generator.generate(data, contents);
+				INIWriter writer(filename);
+				writer.atomicWrite = true;
+				writer.stats = stats;
+				return writer.writeOutput(contents);
+			}
+			INIGenerator generator(filename);
+			generator.prettyPrint = pretty;
+			generator.stats = stats;
+			return generator << data;
+		}
+		bool readOriginal(INIReader& reader) const
+		{
+			state.original.clear();
+			if (!(reader >> state.original))
+			{
+				forget();
+				return false;
+			}
+			state.lineData = reader.getLines();
+			state.isBOM = reader.isBOM;
+			return true;
+		}
 
 	public:
+		// keep the lines read from or written to the file, so write() doesn't
+		// need to read it again as long as nobody else changed it
+		bool cacheContents = false;
+		// replace the file through a temporary file instead of overwriting it
+		bool atomicWrite = false;
+		// let write() return right away if neither the structure nor the file
+		// changed since the last read or write; values assigned through a
+		// reference taken with [] before that are not noticed as changes
+		bool skipUnchanged = false;
+		// passed on to the readers, writers and generators used by this file
+		INIStats* stats = nullptr;
+
 		INIFile(std::filesystem::path filename)
 		: filename(std::move(filename))
 		{ }
+		// copies the file name and settings, but nothing that is kept about the file
+		INIFile(INIFile const& other)
+		: filename(other.filename)
+		, cacheContents(other.cacheContents)
+		, atomicWrite(other.atomicWrite)
+		, skipUnchanged(other.skipUnchanged)
+		, stats(other.stats)
+		{ }
+		INIFile& operator=(INIFile const& other)
+		{
+			if (this != &other)
+			{
+				std::lock_guard<std::mutex> lock(stateMutex);
+				forget();
+				filename = other.filename;
+				cacheContents = other.cacheContents;
+				atomicWrite = other.atomicWrite;
+				skipUnchanged = other.skipUnchanged;
+				stats = other.stats;
+			}
+			return *this;
+		}
 
 		~INIFile() = default;
 
 		bool read(INIStructure& data) const
 		{
+			MINI_TRACE_SPAN(span, "INIFile::read");
 			if (data.size() != 0U)
 			{
 				data.clear();
 			}
+			if (!keepsState())
+			{
+				dropState();
+				if (filename.empty())
+				{
+					return false;
+				}
+				INIReader reader(filename);
+				reader.stats = stats;
+				return reader >> data;
+			}
+			std::lock_guard<std::mutex> lock(stateMutex);
+			forget();
 			if (filename.empty())
 			{
 				return false;
 			}
-			INIReader reader(filename);
-			return reader >> data;
+			INIFileStamp stamp;
+			const bool hasStamp = stamp.read(filename);
+			INIReader reader(filename, cacheContents);
+			reader.stats = stats;
+			if (!(reader >> data))
+			{
+				return false;
+			}
+			if (hasStamp)
+			{
+				state.stamp = stamp;
+				state.valid = true;
+				state.data = &data;
+				track(data);
+				hasState.store(true, std::memory_order_release);
+				if (cacheContents)
+				{
+					state.lineData = reader.getLines();
+					state.original = data;
+					state.isBOM = reader.isBOM;
+				}
+			}
+			return true;
 		}
 		[[nodiscard]] bool generate(INIStructure const& data, bool pretty = false) const
 		{
-			if (filename.empty())
+			MINI_TRACE_SPAN(span, "INIFile::generate");
+			if (!keepsState())
 			{
-				return false;
+				dropState();
+				return generateFile(data, pretty);
 			}
-			INIGenerator generator(filename);
-			generator.prettyPrint = pretty;
-			return generator << data;
+			std::lock_guard<std::mutex> lock(stateMutex);
+			forget();
+			return setSynced(data, generateFile(data, pretty));
 		}
 		bool write(INIStructure& data, bool pretty = false) const
 		{
+			MINI_TRACE_SPAN(span, "INIFile::write");
 			if (filename.empty())
 			{
 				return false;
 			}
 			INIWriter writer(filename);
 			writer.prettyPrint = pretty;
-			return writer << data;
+			writer.atomicWrite = atomicWrite;
+			writer.stats = stats;
+			if (!keepsState())
+			{
+				dropState();
+				return writer << data;
+			}
+			std::lock_guard<std::mutex> lock(stateMutex);
+			INIFileStamp stamp;
+			if (!stamp.read(filename))
+			{
+				forget();
+				return setSynced(data, writer << data);
+			}
+			const bool unchanged = (state.valid && stamp == state.stamp);
+			const bool synced = (unchanged && state.data == &data);
+			const bool tracked = (synced && state.tracker.isStarted());
+			if (skipUnchanged && tracked && data.generation() == state.generation)
+			{
+				return true;
+			}
+			if (!unchanged || !state.lineData)
+			{
+				INIReader reader(filename, true);
+				reader.stats = stats;
+				if (!readOriginal(reader))
+				{
+					return false;
+				}
+			}
+			writer.syncedGeneration = (tracked) ? state.generation : 0;
+			INIReader::T_LineDataPtr outputLines;
+			const std::string contents = writer.getOutput(data, state.lineData, state.original, state.isBOM, outputLines);
+			if (!writer.writeOutput(contents))
+			{
+				forget();
+				return false;
+			}
+			const bool isBOM = state.isBOM;
+			forget();
+			if (setSynced(data, true) && cacheContents)
+			{
+				// the written lines hold data, so they are kept as if they were
+				// read; an empty file is read as no lines rather than one empty line
+				if (contents.empty())
+				{
+					outputLines->clear();
+				}
+				state.lineData = std::move(outputLines);
+				state.original = data;
+				state.isBOM = isBOM;
+			}
+			return true;
 		}
 	};
 }
@@ -0,0 +1,479 @@
+/*
+ * The MIT License (MIT)
+ * Copyright (c) 2018 Danijel Durakovic
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+///////////////////////////////////////////////////////////////////////////////
+//
+//  /mINI/ journal
+//  Persists changes to an INI structure by appending them to the file.
+//
+///////////////////////////////////////////////////////////////////////////////
+//
+//  INIJournal writes only what changed in a structure since it was last
+//  read or written: every added or changed key is appended to the end of the
+//  file as a plain "key=value" line, preceded by its section header when
+//  needed. Since later keys override earlier ones on read, the file always
+//  reads back as the current structure and any INI reader can load it.
+//
+//  Changes are found by comparing the structure with a copy of it as it was
+//  last synced, so values changed through references taken earlier are
+//  written too. Keeping the copy takes as much memory as the structure, and
+//  each write() compares every key.
+//
+//  Each batch of changes is appended with a single write, framed by two
+//  comment lines: ";mINI:begin" before it and ";mINI:commit <size> <hash>"
+//  after it, holding the size and FNV-1a hash of the lines in between.
+//  Other readers skip the comments. read() only replays batches whose
+//  commit line matches, so an interrupted write never shows up as a state
+//  that didn't exist. The file is never truncated: anything the journal
+//  didn't append, including a last line without a line break, is read as
+//  it is, and a skipped batch makes the next write() compact the file.
+//
+//  Removed keys and sections can't be expressed as appended lines, so
+//  removing anything makes the next write() compact the file: it is
+//  generated from scratch into a temporary file in the same directory,
+//  synced and renamed over the journal. Compaction also happens once the
+//  appended lines outgrow the compacted file, when the file was changed by
+//  someone else or when a different structure is written.
+//
+//  POSIX only.
+//
+///////////////////////////////////////////////////////////////////////////////
+//
+//  /* BASIC USAGE EXAMPLE: */
+//
+//  mINI::INIJournal journal("myfile.ini");
+//  mINI::INIStructure ini;
+//  journal.read(ini);
+//
+//  ini["section"]["key"] = "value";
+//  journal.write(ini); // appends "key=value" under [section]
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef MINI_JOURNAL_H_
+#define MINI_JOURNAL_H_
+
+#if defined(__unix__) || defined(__APPLE__)
+
+#include <sstream>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "ini.h"
+
+namespace mINI
+{
+	class INIJournal
+	{
+	private:
+		std::filesystem::path filename;
+		int fd = -1;
+		INIFileStamp stamp;
+		// the structure as it was last read or written, and which one it was
+		INIStructure synced;
+		INIStructure const* syncedData = nullptr;
+		std::string lastSection;
+		bool hasLastSection = false;
+		std::size_t compactedSize = 0;
+		std::size_t appendedSize = 0;
+		bool endsWithLineBreak = true;
+		bool hasSkippedBatches = false;
+		std::string buffer;
+		std::string batch;
+
+		static constexpr std::string_view batchBegin = ";mINI:begin";
+		static constexpr std::string_view batchCommit = ";mINI:commit ";
+
+		static bool writeAll(int fd, std::string_view data)
+		{
+			while (!data.empty())
+			{
+				const auto written = ::write(fd, data.data(), data.size());
+				if (written < 0)
+				{
+					return false;
+				}
+				data.remove_prefix(static_cast<std::size_t>(written));
+			}
+			return true;
+		}
+		static bool syncFile(int fd)
+		{
+#ifdef __APPLE__
+			return ::fsync(fd) == 0;
+#else
+			return ::fdatasync(fd) == 0;
+#endif
+		}
+		static std::uint64_t checksum(std::string_view data)
+		{
+			std::uint64_t hash = 14695981039346656037ULL;
+			for (const char c : data)
+			{
+				hash ^= static_cast<unsigned char>(c);
+				hash *= 1099511628211ULL;
+			}
+			return hash;
+		}
+		static void appendCommit(std::string& output, std::string_view body)
+		{
+			static constexpr char digits[] = "0123456789abcdef";
+			const std::uint64_t hash = checksum(body);
+			output += batchCommit;
+			INIStringUtil::appendNumber(output, body.size());
+			output += ' ';
+			for (int shift = 60; shift >= 0; shift -= 4)
+			{
+				output += digits[(hash >> shift) & 0xF];
+			}
+			output += INIStringUtil::endl;
+		}
+		static bool isCommitted(std::string_view commitLine, std::string_view body)
+		{
+			std::string expected;
+			appendCommit(expected, body);
+			if (!commitLine.empty() && commitLine.back() == '\r')
+			{
+				commitLine.remove_suffix(1);
+			}
+			return INIStringUtil::trimView(expected) == commitLine;
+		}
+		static std::string_view getLine(std::string_view contents, std::size_t position, std::size_t& next)
+		{
+			const std::size_t lineEnd = contents.find('\n', position);
+			next = (lineEnd == std::string_view::npos) ? contents.size() : lineEnd + 1;
+			return contents.substr(position, next - position);
+		}
+		static bool isBatchBegin(std::string_view line)
+		{
+			return INIStringUtil::trimView(line) == batchBegin && line.back() == '\n';
+		}
+		// copies contents to output without batches that were never
+		// committed; returns false if any were left out
+		static bool getCommitted(std::string_view contents, std::string& output)
+		{
+			output.reserve(contents.size());
+			bool complete = true;
+			std::size_t position = 0;
+			while (position < contents.size())
+			{
+				std::size_t next;
+				const auto line = getLine(contents, position, next);
+				if (!isBatchBegin(line))
+				{
+					output += line;
+					position = next;
+					continue;
+				}
+				// the batch ends at its commit line, or where the next batch starts
+				const std::size_t bodyAt = next;
+				std::size_t lineAt = bodyAt;
+				bool committed = false;
+				while (lineAt < contents.size())
+				{
+					const auto bodyLine = getLine(contents, lineAt, next);
+					if (isBatchBegin(bodyLine))
+					{
+						break;
+					}
+					if (bodyLine.substr(0, batchCommit.size()) == batchCommit)
+					{
+						const auto body = contents.substr(bodyAt, lineAt - bodyAt);
+						committed = (bodyLine.back() == '\n' && isCommitted(bodyLine.substr(0, bodyLine.size() - 1), body));
+						if (committed)
+						{
+							output += body;
+						}
+						lineAt = next;
+						break;
+					}
+					lineAt = next;
+				}
+				complete = complete && committed;
+				position = lineAt;
+			}
+			return complete;
+		}
+		static bool readContents(std::filesystem::path const& filename, std::string& contents)
+		{
+			std::ifstream fileReadStream(filename, std::ios::in | std::ios::binary);
+			if (!fileReadStream.is_open())
+			{
+				return false;
+			}
+			std::ostringstream contentsStream;
+			contentsStream << fileReadStream.rdbuf();
+			contents = contentsStream.str();
+			return true;
+		}
+
+		void close()
+		{
+			if (fd >= 0)
+			{
+				::close(fd);
+				fd = -1;
+			}
+		}
+		bool open()
+		{
+			if (fd < 0)
+			{
+				fd = ::open(filename.c_str(), O_WRONLY | O_APPEND | O_CREAT, 0644);
+			}
+			return fd >= 0;
+		}
+		void setSynced(INIStructure const& data, std::size_t size)
+		{
+			syncedData = (stamp.read(filename)) ? &data : nullptr;
+			compactedSize = size;
+			appendedSize = 0;
+		}
+		void appendSection(std::string const& section)
+		{
+			buffer += '[';
+			buffer += section;
+			buffer += ']';
+			buffer += INIStringUtil::endl;
+			lastSection = section;
+			hasLastSection = true;
+		}
+		void appendKey(std::string const& key, std::string const& value)
+		{
+			for (const char c : key)
+			{
+				if (c == '=')
+				{
+					buffer += '\\';
+				}
+				buffer += c;
+			}
+			buffer += (prettyPrint) ? " = " : "=";
+			buffer += INIStringUtil::trimView(value);
+			buffer += INIStringUtil::endl;
+		}
+		// collects everything changed since the last sync and updates the
+		// synced copy to match; false if something was removed and the file
+		// has to be compacted instead
+		bool collectChanges(INIStructure const& data)
+		{
+			const std::size_t syncedSections = synced.size();
+			std::size_t foundSections = 0;
+			for (auto const& it : data)
+			{
+				auto const& section = it.first;
+				auto const& collection = it.second;
+				auto syncedIt = synced.dataIndexMap.find(section);
+				if (syncedIt == synced.dataIndexMap.end())
+				{
+					if (!hasLastSection || lastSection != section)
+					{
+						appendSection(section);
+					}
+					for (auto const& it2 : collection)
+					{
+						appendKey(it2.first, it2.second);
+					}
+					synced[section] = collection;
+					continue;
+				}
+				++foundSections;
+				auto& syncedCollection = synced.data[syncedIt->second].second;
+				const std::size_t syncedKeys = syncedCollection.size();
+				std::size_t foundKeys = 0;
+				for (auto const& it2 : collection)
+				{
+					auto const& key = it2.first;
+					auto const& value = it2.second;
+					auto keyIt = syncedCollection.dataIndexMap.find(key);
+					if (keyIt != syncedCollection.dataIndexMap.end())
+					{
+						++foundKeys;
+						auto& syncedValue = syncedCollection.data[keyIt->second].second;
+						if (syncedValue == value)
+						{
+							continue;
+						}
+						syncedValue = value;
+					}
+					else
+					{
+						syncedCollection[key] = value;
+					}
+					if (!hasLastSection || lastSection != section)
+					{
+						appendSection(section);
+					}
+					appendKey(key, value);
+				}
+				if (foundKeys != syncedKeys)
+				{
+					return false;
+				}
+			}
+			return foundSections == syncedSections;
+		}
+
+	public:
+		bool prettyPrint = false;
+		// fdatasync() after every write; compaction always syncs
+		bool syncToDisk = false;
+		// appended lines are compacted once they exceed both this many bytes
+		// and the size of the file after the last compaction
+		std::size_t compactionThreshold = 64 * 1024;
+
+		explicit INIJournal(std::filesystem::path filename)
+		: filename(std::move(filename))
+		{ }
+		~INIJournal()
+		{
+			close();
+		}
+
+		INIJournal(INIJournal const&) = delete;
+		INIJournal& operator=(INIJournal const&) = delete;
+
+		bool read(INIStructure& data)
+		{
+			if (data.size() != 0U)
+			{
+				data.clear();
+			}
+			close();
+			syncedData = nullptr;
+			hasLastSection = false;
+			std::string contents;
+			if (!readContents(filename, contents))
+			{
+				return false;
+			}
+			std::string committed;
+			hasSkippedBatches = !getCommitted(contents, committed);
+			endsWithLineBreak = (contents.empty() || contents.back() == '\n');
+			if (!(INIReader::fromString(committed) >> data))
+			{
+				return false;
+			}
+			synced = data;
+			setSynced(data, contents.size());
+			return true;
+		}
+		// appends changes made to data since the last read(), write() or
+		// compact() of this journal; compacts the file if that isn't possible
+		bool write(INIStructure const& data)
+		{
+			INIFileStamp current;
+			if (syncedData != &data || hasSkippedBatches || !current.read(filename) || current != stamp)
+			{
+				return compact(data);
+			}
+			buffer.clear();
+			const std::string previousSection = lastSection;
+			const bool hadLastSection = hasLastSection;
+			if (!collectChanges(data))
+			{
+				lastSection = previousSection;
+				hasLastSection = hadLastSection;
+				return compact(data);
+			}
+			if (buffer.empty())
+			{
+				return true;
+			}
+			batch.clear();
+			if (!endsWithLineBreak)
+			{
+				batch += INIStringUtil::endl;
+			}
+			batch += batchBegin;
+			batch += INIStringUtil::endl;
+			batch += buffer;
+			appendCommit(batch, buffer);
+			syncedData = nullptr;
+			if (!open() || !writeAll(fd, batch) || (syncToDisk && !syncFile(fd)))
+			{
+				hasLastSection = false;
+				return false;
+			}
+			endsWithLineBreak = true;
+			const std::size_t size = compactedSize;
+			const std::size_t appended = appendedSize + batch.size();
+			setSynced(data, size);
+			appendedSize = appended;
+			if (appendedSize > std::max(compactionThreshold, compactedSize))
+			{
+				return compact(data);
+			}
+			return true;
+		}
+		// rewrites the file from data without any superseded lines
+		bool compact(INIStructure const& data)
+		{
+			INIGenerator generator;
+			generator.prettyPrint = prettyPrint;
+			buffer.clear();
+			generator.generate(data, buffer);
+			if (!buffer.empty())
+			{
+				buffer += INIStringUtil::endl;
+			}
+			syncedData = nullptr;
+			hasLastSection = false;
+			// a symlinked journal stays a link to the compacted file
+			const auto target = INIWriter::resolveSymlinks(filename);
+			std::filesystem::path tempFilename;
+			const int tempFd = INIWriter::openTempFile(target, tempFilename);
+			if (tempFd < 0)
+			{
+				return false;
+			}
+			struct stat fileStat;
+			if (::stat(target.c_str(), &fileStat) == 0)
+			{
+				INIWriter::copyAttributes(tempFd, fileStat);
+			}
+			const bool success = writeAll(tempFd, buffer) && syncFile(tempFd);
+			if (::close(tempFd) != 0 || !success || ::rename(tempFilename.c_str(), target.c_str()) != 0)
+			{
+				::unlink(tempFilename.c_str());
+				return false;
+			}
+			INIWriter::syncDirectory(target);
+			close();
+			endsWithLineBreak = true;
+			hasSkippedBatches = false;
+			if (data.size() != 0U)
+			{
+				lastSection = (data.end() - 1)->first;
+				hasLastSection = true;
+			}
+			synced = data;
+			setSynced(data, buffer.size());
+			return true;
+		}
+	};
+}
+
+#endif // defined(__unix__) || defined(__APPLE__)
+
+#endif // MINI_JOURNAL_H_
@@ -0,0 +1,186 @@
+/*
+ * The MIT License (MIT)
+ * Copyright (c) 2018 Danijel Durakovic
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+///////////////////////////////////////////////////////////////////////////////
+//
+//  /mINI/ parallel generation
+//  Generates huge structures on several threads.
+//
+///////////////////////////////////////////////////////////////////////////////
+//
+//  INIParallelGenerator splits the sections of a structure into contiguous
+//  ranges holding about the same number of keys. Each thread first measures
+//  the sections of its range. The sizes then give every section its offset
+//  in one shared output buffer, and the threads render their ranges straight
+//  to those offsets. The buffer is written to the file in one piece. Output
+//  is byte-identical to INIGenerator.
+//
+//  Structures with few keys are generated on the calling thread.
+//
+///////////////////////////////////////////////////////////////////////////////
+//
+//  /* BASIC USAGE EXAMPLE: */
+//
+//  mINI::INIParallelGenerator generator("myfile.ini");
+//  generator.threadCount = 8;
+//  bool generateSuccess = generator << ini;
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef MINI_PARALLEL_H_
+#define MINI_PARALLEL_H_
+
+#include <thread>
+#include "ini.h"
+
+namespace mINI
+{
+	class INIParallelGenerator
+	{
+	private:
+		using T_Range = std::pair<std::size_t, std::size_t>;
+
+		// below this many keys per thread, starting threads isn't worth it
+		static constexpr std::size_t minKeysPerThread = 4096;
+
+		std::filesystem::path filename;
+
+		// ranges of sections with about the same number of keys each
+		std::vector<T_Range> getRanges(INIStructure const& data) const
+		{
+			std::size_t keyCount = data.size();
+			for (auto const& it : data)
+			{
+				keyCount += it.second.size();
+			}
+			std::size_t rangeCount = std::min(threadCount, keyCount / minKeysPerThread);
+			rangeCount = std::max<std::size_t>(std::min(rangeCount, data.size()), 1);
+			std::vector<T_Range> ranges;
+			ranges.reserve(rangeCount);
+			std::size_t first = 0;
+			std::size_t keysDone = 0;
+			std::size_t index = 0;
+			for (auto const& it : data)
+			{
+				keysDone += it.second.size() + 1;
+				++index;
+				if (keysDone * rangeCount >= keyCount * (ranges.size() + 1))
+				{
+					ranges.emplace_back(first, index);
+					first = index;
+				}
+			}
+			if (first != index || ranges.empty())
+			{
+				ranges.emplace_back(first, index);
+			}
+			return ranges;
+		}
+		template<typename T_Task>
+		static void run(std::vector<T_Range> const& ranges, T_Task const& task)
+		{
+			std::vector<std::thread> threads;
+			threads.reserve(ranges.size() - 1);
+			for (std::size_t i = 1; i < ranges.size(); ++i)
+			{
+				threads.emplace_back(task, ranges[i]);
+			}
+			task(ranges[0]);
+			for (auto& thread : threads)
+			{
+				thread.join();
+			}
+		}
+		void render(INIStructure const& data, std::string& output)
+		{
+			INIGenerator generator;
+			generator.prettyPrint = prettyPrint;
+			const auto ranges = getRanges(data);
+			const auto sections = data.begin();
+			// offsets[i] is where the separator in front of section i starts
+			std::vector<std::size_t> offsets(data.size() + 1);
+			run(ranges, [&](T_Range const& range) {
+				for (std::size_t i = range.first; i < range.second; ++i)
+				{
+					offsets[i + 1] = generator.getSectionSize(sections[i].first, sections[i].second);
+				}
+			});
+			const std::size_t separatorSize = generator.getSeparatorSize();
+			for (std::size_t i = 1; i < offsets.size(); ++i)
+			{
+				offsets[i] += offsets[i - 1] + ((i > 1) ? separatorSize : 0);
+			}
+			outputSize = offsets.back();
+			output.resize(outputSize);
+			run(ranges, [&](T_Range const& range) {
+				for (std::size_t i = range.first; i < range.second; ++i)
+				{
+					char* position = output.data() + offsets[i];
+					if (i != 0)
+					{
+						position = INIGenerator::append(position, INIStringUtil::endl);
+						if (prettyPrint)
+						{
+							position = INIGenerator::append(position, INIStringUtil::endl);
+						}
+					}
+					generator.renderSection(position, sections[i].first, sections[i].second);
+				}
+			});
+		}
+
+	public:
+		bool prettyPrint = false;
+		std::size_t threadCount = std::max(std::thread::hardware_concurrency(), 1U);
+		// size of the last generated output
+		std::size_t outputSize = 0;
+
+		// generates to memory only
+		INIParallelGenerator() = default;
+		INIParallelGenerator(std::filesystem::path filename)
+		: filename(std::move(filename))
+		{
+		}
+		~INIParallelGenerator() = default;
+
+		bool operator<<(INIStructure const& data)
+		{
+			std::ofstream fileWriteStream(filename, std::ios::out | std::ios::binary);
+			if (!fileWriteStream.is_open())
+			{
+				return false;
+			}
+			std::string output;
+			generate(data, output);
+			fileWriteStream.write(output.data(), static_cast<std::streamsize>(output.size()));
+			return fileWriteStream.good();
+		}
+		bool generate(INIStructure const& data, std::string& output)
+		{
+			render(data, output);
+			return true;
+		}
+	};
+}
+
+#endif // MINI_PARALLEL_H_
@@ -0,0 +1,454 @@
+/*
+ * The MIT License (MIT)
+ * Copyright (c) 2018 Danijel Durakovic
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+///////////////////////////////////////////////////////////////////////////////
+//
+//  /mINI/ schema binding
+//  Reads and writes INI files straight from and into a C++ struct.
+//
+///////////////////////////////////////////////////////////////////////////////
+//
+//  Fields are described once with their section and key names, member and
+//  default value. Name hashes and the dispatch table are built at compile
+//  time; when reading, every key/value line is hashed and assigned directly
+//  to its member without building an INIStructure. Writing renders the struct
+//  into a single buffer in the same format generate() uses.
+//
+///////////////////////////////////////////////////////////////////////////////
+//
+//  /* BASIC USAGE EXAMPLE: */
+//
+//  struct Settings
+//  {
+//      int width;
+//      double scale;
+//      std::string title;
+//  };
+//
+//  constexpr mINI::INISchema settingsSchema {
+//      mINI::INIField("window", "width", &Settings::width, 800),
+//      mINI::INIField("window", "scale", &Settings::scale, 1.0),
+//      mINI::INIField("window", "title", &Settings::title, "untitled")
+//  };
+//
+//  Settings settings;
+//  mINI::INISchemaReport report = settingsSchema.read("settings.ini", settings);
+//
+//  /* write the struct back, formatted like generate() */
+//  settingsSchema.generate("settings.ini", settings);
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef MINI_SCHEMA_H_
+#define MINI_SCHEMA_H_
+
+#include <array>
+#include <cstdint>
+#include <exception>
+#include <string_view>
+#include <system_error>
+#include <tuple>
+#include "ini.h"
+
+namespace mINI
+{
+	namespace INISchemaUtil
+	{
+		constexpr std::uint64_t hashBasis = 14695981039346656037ULL;
+		constexpr std::uint64_t hashPrime = 1099511628211ULL;
+
+		constexpr std::uint64_t hashName(std::uint64_t hash, std::string_view name)
+		{
+			for (const char c : name)
+			{
+				hash = (hash ^ static_cast<unsigned char>(INIStringUtil::foldCase(c))) * hashPrime;
+			}
+			// terminate the name so that "ab" + "c" and "a" + "bc" differ
+			return (hash ^ 0xFFU) * hashPrime;
+		}
+		constexpr std::uint64_t hashName(std::string_view section, std::string_view key)
+		{
+			return hashName(hashName(hashBasis, section), key);
+		}
+
+		inline bool parseValue(std::string_view value, std::string& out)
+		{
+			out.assign(value.data(), value.size());
+			return true;
+		}
+		inline bool parseValue(std::string_view value, bool& out)
+		{
+			for (auto name : { "true", "yes", "on", "1" })
+			{
+				if (INIStringUtil::namesEqual(value, name))
+				{
+					out = true;
+					return true;
+				}
+			}
+			for (auto name : { "false", "no", "off", "0" })
+			{
+				if (INIStringUtil::namesEqual(value, name))
+				{
+					out = false;
+					return true;
+				}
+			}
+			return false;
+		}
+		template<typename T>
+		std::enable_if_t<std::is_arithmetic_v<T>, bool> parseValue(std::string_view value, T& out)
+		{
+			if (!value.empty() && value[0] == '+')
+			{
+				value.remove_prefix(1);
+			}
+			T result {};
+			const auto end = value.data() + value.size();
+			const auto parsed = std::from_chars(value.data(), end, result);
+			if (parsed.ec != std::errc() || parsed.ptr != end)
+			{
+				return false;
+			}
+			out = result;
+			return true;
+		}
+
+		inline void appendName(std::string& out, std::string_view name, bool escape)
+		{
+			for (const char c : name)
+			{
+				if (escape && c == '=')
+				{
+					out += '\\';
+				}
+				out += INIStringUtil::foldCase(c);
+			}
+		}
+		inline void appendValue(std::string& out, std::string const& value)
+		{
+			const auto first = value.find_first_not_of(INIStringUtil::whitespaceDelimiters);
+			if (first != std::string::npos)
+			{
+				const auto last = value.find_last_not_of(INIStringUtil::whitespaceDelimiters);
+				out.append(value, first, last - first + 1);
+			}
+		}
+		template<typename T>
+		std::enable_if_t<std::is_arithmetic_v<T>> appendValue(std::string& out, T value)
+		{
+			INIStringUtil::appendNumber(out, value);
+		}
+
+		[[noreturn]] inline void duplicateField()
+		{
+			// reached only while building a schema at runtime; a constexpr
+			// schema with duplicate names fails to compile on this call
+			std::terminate();
+		}
+	}
+
+	template<typename C, typename M, typename D>
+	struct INIField
+	{
+		using T_Class = C;
+		using T_Member = M;
+
+		std::string_view section;
+		std::string_view key;
+		M C::* member;
+		D defaultValue;
+		std::uint64_t hash;
+
+		constexpr INIField(std::string_view section, std::string_view key, M C::* member, D defaultValue)
+		: section(section)
+		, key(key)
+		, member(member)
+		, defaultValue(defaultValue)
+		, hash(INISchemaUtil::hashName(section, key))
+		{
+		}
+	};
+
+	struct INISchemaReport
+	{
+		using T_Names = std::vector<std::pair<std::string, std::string>>;
+
+		bool readSuccess = false;
+		T_Names missing;
+		T_Names unknown;
+		T_Names invalid;
+
+		[[nodiscard]] bool complete() const
+		{
+			return readSuccess && missing.empty() && unknown.empty() && invalid.empty();
+		}
+	};
+
+	template<typename... T_Fields>
+	class INISchema
+	{
+	public:
+		using T_Class = typename std::tuple_element_t<0, std::tuple<T_Fields...>>::T_Class;
+
+		static constexpr std::size_t fieldCount = sizeof...(T_Fields);
+
+	private:
+		static_assert(fieldCount > 0, "schema requires at least one field");
+		static_assert((std::is_same_v<T_Class, typename T_Fields::T_Class> && ...), "schema fields must belong to the same struct");
+
+		struct T_IndexItem
+		{
+			std::uint64_t hash;
+			std::size_t field;
+		};
+		using T_Index = std::array<T_IndexItem, fieldCount>;
+		using T_Order = std::array<std::size_t, fieldCount>;
+		using T_Fieldset = std::tuple<T_Fields...>;
+
+		T_Fieldset fields;
+		T_Index index;
+		T_Order order;
+		std::size_t namesLength;
+
+		static constexpr T_Index makeIndex(std::array<std::uint64_t, fieldCount> const& hashes)
+		{
+			T_Index result {};
+			for (std::size_t i = 0; i < fieldCount; ++i)
+			{
+				std::size_t j = i;
+				while (j > 0 && result[j - 1].hash > hashes[i])
+				{
+					result[j] = result[j - 1];
+					--j;
+				}
+				result[j] = T_IndexItem { hashes[i], i };
+			}
+			return result;
+		}
+		template<std::size_t... I>
+		constexpr T_Order makeOrder(std::index_sequence<I...>) const
+		{
+			// fields grouped by section in order of first appearance,
+			// declaration order is kept within a section
+			const std::array<std::string_view, fieldCount> sections { std::get<I>(fields).section... };
+			T_Order result {};
+			std::array<bool, fieldCount> placed {};
+			std::size_t count = 0;
+			for (std::size_t i = 0; i < fieldCount; ++i)
+			{
+				if (placed[i])
+				{
+					continue;
+				}
+				for (std::size_t j = i; j < fieldCount; ++j)
+				{
+					if (!placed[j] && INIStringUtil::namesEqual(sections[i], sections[j]))
+					{
+						placed[j] = true;
+						result[count++] = j;
+					}
+				}
+			}
+			return result;
+		}
+		template<std::size_t... I>
+		constexpr void checkDuplicates(std::index_sequence<I...>) const
+		{
+			const std::array<std::string_view, fieldCount> sections { std::get<I>(fields).section... };
+			const std::array<std::string_view, fieldCount> keys { std::get<I>(fields).key... };
+			for (std::size_t i = 1; i < fieldCount; ++i)
+			{
+				for (std::size_t j = i; j > 0 && index[j - 1].hash == index[i].hash; --j)
+				{
+					const std::size_t a = index[i].field;
+					const std::size_t b = index[j - 1].field;
+					if (INIStringUtil::namesEqual(sections[a], sections[b]) && INIStringUtil::namesEqual(keys[a], keys[b]))
+					{
+						INISchemaUtil::duplicateField();
+					}
+				}
+			}
+		}
+
+		template<std::size_t... I>
+		void applyDefaults(T_Class& obj, std::index_sequence<I...>) const
+		{
+			((obj.*(std::get<I>(fields).member) = std::get<I>(fields).defaultValue), ...);
+		}
+		template<std::size_t... I>
+		bool matches(std::size_t fieldIndex, std::string_view section, std::string_view key, std::index_sequence<I...>) const
+		{
+			bool result = false;
+			((I == fieldIndex && (result =
+				INIStringUtil::namesEqual(std::get<I>(fields).section, section) &&
+				INIStringUtil::namesEqual(std::get<I>(fields).key, key)
+			)) || ...);
+			return result;
+		}
+		template<std::size_t... I>
+		bool assign(std::size_t fieldIndex, T_Class& obj, std::string_view value, std::index_sequence<I...>) const
+		{
+			bool result = false;
+			((I == fieldIndex && (result = INISchemaUtil::parseValue(value, obj.*(std::get<I>(fields).member)), true)) || ...);
+			return result;
+		}
+		template<std::size_t... I>
+		void appendField(std::size_t fieldIndex, T_Class const& obj, std::string& output, bool prettyPrint, std::index_sequence<I...>) const
+		{
+			((I == fieldIndex && (
+				INISchemaUtil::appendName(output, std::get<I>(fields).key, true),
+				output += (prettyPrint) ? " = " : "=",
+				INISchemaUtil::appendValue(output, obj.*(std::get<I>(fields).member)),
+				true
+			)) || ...);
+		}
+		template<std::size_t... I>
+		std::string_view sectionOf(std::size_t fieldIndex, std::index_sequence<I...>) const
+		{
+			std::string_view result;
+			((I == fieldIndex && (result = std::get<I>(fields).section, true)) || ...);
+			return result;
+		}
+		template<std::size_t... I>
+		void reportMissing(std::array<bool, fieldCount> const& found, INISchemaReport& report, std::index_sequence<I...>) const
+		{
+			((found[I] ? void() : void(report.missing.emplace_back(
+				std::get<I>(fields).section,
+				std::get<I>(fields).key
+			))), ...);
+		}
+
+		std::size_t find(std::uint64_t hash, std::string_view section, std::string_view key) const
+		{
+			auto it = std::lower_bound(index.begin(), index.end(), hash, [](T_IndexItem const& item, std::uint64_t h) {
+				return item.hash < h;
+			});
+			for (; it != index.end() && it->hash == hash; ++it)
+			{
+				if (matches(it->field, section, key, std::index_sequence_for<T_Fields...>()))
+				{
+					return it->field;
+				}
+			}
+			return fieldCount;
+		}
+
+	public:
+		constexpr INISchema(T_Fields... fields)
+		: fields(fields...)
+		, index(makeIndex({ fields.hash... }))
+		, order(makeOrder(std::index_sequence_for<T_Fields...>()))
+		, namesLength(((fields.section.size() + fields.key.size()) + ...))
+		{
+			checkDuplicates(std::index_sequence_for<T_Fields...>());
+		}
+
+		void defaults(T_Class& obj) const
+		{
+			applyDefaults(obj, std::index_sequence_for<T_Fields...>());
+		}
+
+		INISchemaReport read(std::filesystem::path const& filename, T_Class& obj) const
+		{
+			INISchemaReport report;
+			defaults(obj);
+			std::array<bool, fieldCount> found {};
+			std::string section;
+			std::uint64_t sectionHash = 0;
+			bool inSection = false;
+			INIReader reader(filename);
+			report.readSuccess = reader.visit([&](std::string const&, INIParser::PDataType parseResult, INIParser::T_ParseValues const& parseData) {
+				if (parseResult == INIParser::PDataType::PDATA_SECTION)
+				{
+					inSection = true;
+					section = parseData.first;
+					sectionHash = INISchemaUtil::hashName(INISchemaUtil::hashBasis, section);
+				}
+				else if (inSection && parseResult == INIParser::PDataType::PDATA_KEYVALUE)
+				{
+					auto const& key = parseData.first;
+					auto const& value = parseData.second;
+					const std::size_t fieldIndex = find(INISchemaUtil::hashName(sectionHash, key), section, key);
+					if (fieldIndex == fieldCount)
+					{
+						report.unknown.emplace_back(section, key);
+					}
+					else
+					{
+						found[fieldIndex] = true;
+						if (!assign(fieldIndex, obj, value, std::index_sequence_for<T_Fields...>()))
+						{
+							report.invalid.emplace_back(section, key);
+						}
+					}
+				}
+			});
+			reportMissing(found, report, std::index_sequence_for<T_Fields...>());
+			return report;
+		}
+
+		void render(T_Class const& obj, std::string& output, bool prettyPrint = false) const
+		{
+			output.clear();
+			output.reserve(namesLength + fieldCount * 32);
+			std::string_view sectionCurrent;
+			for (std::size_t i = 0; i < fieldCount; ++i)
+			{
+				const std::size_t fieldIndex = order[i];
+				const std::string_view section = sectionOf(fieldIndex, std::index_sequence_for<T_Fields...>());
+				if (i == 0 || !INIStringUtil::namesEqual(section, sectionCurrent))
+				{
+					if (i != 0)
+					{
+						output += INIStringUtil::endl;
+						if (prettyPrint)
+						{
+							output += INIStringUtil::endl;
+						}
+					}
+					sectionCurrent = section;
+					output += '[';
+					INISchemaUtil::appendName(output, section, false);
+					output += ']';
+				}
+				output += INIStringUtil::endl;
+				appendField(fieldIndex, obj, output, prettyPrint, std::index_sequence_for<T_Fields...>());
+			}
+		}
+		[[nodiscard]] bool generate(std::filesystem::path const& filename, T_Class const& obj, bool prettyPrint = false) const
+		{
+			std::string output;
+			render(obj, output, prettyPrint);
+			std::ofstream fileWriteStream(filename, std::ios::out | std::ios::binary);
+			if (!fileWriteStream.is_open())
+			{
+				return false;
+			}
+			fileWriteStream.write(output.data(), static_cast<std::streamsize>(output.size()));
+			return fileWriteStream.good();
+		}
+	};
+}
+
+#endif // MINI_SCHEMA_H_
@@ -0,0 +1,172 @@
+/*
+ * The MIT License (MIT)
+ * Copyright (c) 2018 Danijel Durakovic
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+///////////////////////////////////////////////////////////////////////////////
+//
+//  /mINI/ snapshots
+//  Shares a reloadable configuration between threads.
+//
+///////////////////////////////////////////////////////////////////////////////
+//
+//  INISnapshotStore holds an immutable INIStructure. Reloads build a fresh
+//  structure and publish it by switching an atomic slot index; readers never
+//  take a lock and keep whatever snapshot they loaded for as long as they
+//  need it. A snapshot is freed when the last reader holding it lets go.
+//
+//  The store keeps two slots. A reader announces itself on the active slot,
+//  checks that the slot is still active and copies the pointer out. A writer
+//  fills the inactive slot only after readers that announced themselves on
+//  it have left, then makes it active and clears the slot it replaced.
+//  Writers are serialized and may wait for readers that are copying a
+//  pointer; readers only retry if a publish happened in the meantime.
+//
+///////////////////////////////////////////////////////////////////////////////
+//
+//  /* BASIC USAGE EXAMPLE: */
+//
+//  mINI::INISnapshotStore config;
+//
+//  /* reload thread */
+//  config.reload(mINI::INIFile("myfile.ini"));
+//
+//  /* any number of reader threads */
+//  auto snapshot = config.load();
+//  std::string value = snapshot->get("section").get("key");
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef MINI_SNAPSHOT_H_
+#define MINI_SNAPSHOT_H_
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include "ini.h"
+
+namespace mINI
+{
+	class INISnapshotStore
+	{
+	public:
+		using T_Snapshot = std::shared_ptr<const INIStructure>;
+
+	private:
+		struct alignas(64) T_Slot
+		{
+			std::atomic<std::size_t> readers { 0 };
+			T_Snapshot snapshot;
+		};
+
+		mutable T_Slot slots[2];
+		std::atomic<std::size_t> active { 0 };
+		std::mutex publishMutex;
+
+		T_Slot& enter() const
+		{
+			for (;;)
+			{
+				const std::size_t index = active.load();
+				auto& slot = slots[index];
+				slot.readers.fetch_add(1);
+				if (active.load() == index)
+				{
+					return slot;
+				}
+				slot.readers.fetch_sub(1);
+			}
+		}
+		static void drain(T_Slot const& slot)
+		{
+			while (slot.readers.load() != 0)
+			{
+				std::this_thread::yield();
+			}
+		}
+
+	public:
+		INISnapshotStore()
+		: INISnapshotStore(INIStructure())
+		{
+		}
+		explicit INISnapshotStore(INIStructure data)
+		{
+			slots[0].snapshot = std::make_shared<const INIStructure>(std::move(data));
+		}
+		~INISnapshotStore() = default;
+
+		INISnapshotStore(INISnapshotStore const&) = delete;
+		INISnapshotStore& operator=(INISnapshotStore const&) = delete;
+
+		[[nodiscard]] T_Snapshot load() const
+		{
+			auto& slot = enter();
+			T_Snapshot snapshot = slot.snapshot;
+			slot.readers.fetch_sub(1);
+			return snapshot;
+		}
+		// calls visitor with the current structure without copying the snapshot
+		// pointer; a publish waits for the visitor to return, so keep it short
+		template<typename T_Visitor>
+		decltype(auto) read(T_Visitor&& visitor) const
+		{
+			struct T_Leave
+			{
+				T_Slot& slot;
+				~T_Leave() { slot.readers.fetch_sub(1); }
+			} leave { enter() };
+			return visitor(static_cast<INIStructure const&>(*leave.slot.snapshot));
+		}
+
+		void publish(T_Snapshot snapshot)
+		{
+			if (!snapshot)
+			{
+				return;
+			}
+			std::lock_guard<std::mutex> lock(publishMutex);
+			const std::size_t previous = active.load();
+			const std::size_t next = 1 - previous;
+			drain(slots[next]);
+			slots[next].snapshot = std::move(snapshot);
+			active.store(next);
+			drain(slots[previous]);
+			slots[previous].snapshot.reset();
+		}
+		void publish(INIStructure data)
+		{
+			publish(std::make_shared<const INIStructure>(std::move(data)));
+		}
+		bool reload(INIFile const& file)
+		{
+			auto data = std::make_shared<INIStructure>();
+			if (!file.read(*data))
+			{
+				return false;
+			}
+			publish(std::move(data));
+			return true;
+		}
+	};
+}
+
+#endif // MINI_SNAPSHOT_H_
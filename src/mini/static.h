@@ -0,0 +1,244 @@
+/*
+ * The MIT License (MIT)
+ * Copyright (c) 2018 Danijel Durakovic
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+///////////////////////////////////////////////////////////////////////////////
+//
+//  /mINI/ static structures
+//  INI documents parsed at compile time.
+//
+///////////////////////////////////////////////////////////////////////////////
+//
+//  An INI document given as a string literal is parsed by the constexpr
+//  INIParser::parseLine() into a read-only table of views into the literal.
+//  Lookups follow the same rules as INIStructure: names are trimmed and case
+//  insensitive (unless MINI_CASE_SENSITIVE is defined), keys outside of a
+//  section are ignored and later keys override earlier ones.
+//
+///////////////////////////////////////////////////////////////////////////////
+//
+//  /* BASIC USAGE EXAMPLE: */
+//
+//  constexpr std::string_view defaultsText =
+//      "[window]\n"
+//      "width = 800\n";
+//
+//  constexpr mINI::INIStaticStructure<mINI::INIStatic::recordCount(defaultsText)>
+//      defaults(defaultsText);
+//
+//  static_assert(defaults.valid());
+//  static_assert(defaults.get("window").get("width") == "800");
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef MINI_STATIC_H_
+#define MINI_STATIC_H_
+
+#include <array>
+#include <string_view>
+#include "ini.h"
+
+namespace mINI
+{
+	namespace INIStatic
+	{
+		// compares a key as written in the document (with "\=" escapes) to a plain key
+		constexpr bool keysEqual(std::string_view escaped, std::string_view key)
+		{
+			std::size_t j = 0;
+			for (std::size_t i = 0; i < escaped.size(); ++i, ++j)
+			{
+				if (escaped[i] == '\\' && i + 1 < escaped.size() && escaped[i + 1] == '=')
+				{
+					++i;
+				}
+				if (j >= key.size() || INIStringUtil::foldCase(escaped[i]) != INIStringUtil::foldCase(key[j]))
+				{
+					return false;
+				}
+			}
+			return j == key.size();
+		}
+
+		template<typename T_Visitor>
+		constexpr void forEachLine(std::string_view document, T_Visitor&& visitor)
+		{
+			std::size_t lineNumber = 0;
+			while (!document.empty())
+			{
+				const auto newlineAt = document.find('\n');
+				visitor(++lineNumber, document.substr(0, newlineAt));
+				if (newlineAt == std::string_view::npos)
+				{
+					break;
+				}
+				document.remove_prefix(newlineAt + 1);
+			}
+		}
+
+		// number of records (section lines and key/value lines within a section)
+		constexpr std::size_t recordCount(std::string_view document)
+		{
+			std::size_t count = 0;
+			bool inSection = false;
+			forEachLine(document, [&](std::size_t, std::string_view line) {
+				INIParser::T_ParseViews parseData;
+				const auto parseResult = INIParser::parseLine(line, parseData);
+				if (parseResult == INIParser::PDataType::PDATA_SECTION)
+				{
+					inSection = true;
+					++count;
+				}
+				else if (inSection && parseResult == INIParser::PDataType::PDATA_KEYVALUE)
+				{
+					++count;
+				}
+			});
+			return count;
+		}
+	}
+
+	struct INIStaticRecord
+	{
+		std::string_view section;
+		std::string_view key;
+		std::string_view value;
+		bool isSection;
+	};
+
+	class INIStaticSection
+	{
+	private:
+		const INIStaticRecord* first;
+		const INIStaticRecord* last;
+		std::string_view name;
+
+		constexpr const INIStaticRecord* find(std::string_view key) const
+		{
+			key = INIStringUtil::trimView(key);
+			for (auto it = last; it != first; )
+			{
+				--it;
+				if (!it->isSection && INIStringUtil::namesEqual(it->section, name) && INIStatic::keysEqual(it->key, key))
+				{
+					return it;
+				}
+			}
+			return nullptr;
+		}
+
+	public:
+		constexpr INIStaticSection(const INIStaticRecord* first, const INIStaticRecord* last, std::string_view name)
+		: first(first)
+		, last(last)
+		, name(name)
+		{
+		}
+
+		[[nodiscard]] constexpr bool has(std::string_view key) const
+		{
+			return find(key) != nullptr;
+		}
+		[[nodiscard]] constexpr std::string_view get(std::string_view key) const
+		{
+			const auto record = find(key);
+			return (record) ? record->value : std::string_view();
+		}
+	};
+
+	template<std::size_t N>
+	class INIStaticStructure
+	{
+	private:
+		std::array<INIStaticRecord, N> records {};
+		std::size_t firstErrorLine = 0;
+
+	public:
+		constexpr explicit INIStaticStructure(std::string_view document)
+		{
+			std::size_t count = 0;
+			std::string_view section;
+			bool inSection = false;
+			INIStatic::forEachLine(document, [&](std::size_t lineNumber, std::string_view line) {
+				INIParser::T_ParseViews parseData;
+				const auto parseResult = INIParser::parseLine(line, parseData);
+				if (parseResult == INIParser::PDataType::PDATA_SECTION)
+				{
+					inSection = true;
+					section = parseData.first;
+					records[count++] = INIStaticRecord { section, std::string_view(), std::string_view(), true };
+				}
+				else if (parseResult == INIParser::PDataType::PDATA_KEYVALUE && inSection)
+				{
+					records[count++] = INIStaticRecord { section, parseData.first, parseData.second, false };
+				}
+				else if (firstErrorLine == 0 && (parseResult == INIParser::PDataType::PDATA_UNKNOWN || parseResult == INIParser::PDataType::PDATA_KEYVALUE))
+				{
+					firstErrorLine = lineNumber;
+				}
+			});
+		}
+
+		// true when every line is a section, key/value pair, comment or blank
+		[[nodiscard]] constexpr bool valid() const
+		{
+			return firstErrorLine == 0;
+		}
+		// 1-based number of the first line that would be dropped on read, 0 if none
+		[[nodiscard]] constexpr std::size_t errorLine() const
+		{
+			return firstErrorLine;
+		}
+		[[nodiscard]] constexpr bool has(std::string_view section) const
+		{
+			section = INIStringUtil::trimView(section);
+			for (auto const& record : records)
+			{
+				if (record.isSection && INIStringUtil::namesEqual(record.section, section))
+				{
+					return true;
+				}
+			}
+			return false;
+		}
+		[[nodiscard]] constexpr INIStaticSection get(std::string_view section) const
+		{
+			return INIStaticSection(records.data(), records.data() + N, INIStringUtil::trimView(section));
+		}
+		// adds every record to a runtime structure, overriding existing values
+		void copyTo(INIStructure& data) const
+		{
+			std::string key;
+			for (auto const& record : records)
+			{
+				auto& collection = data[std::string(record.section)];
+				if (!record.isSection)
+				{
+					INIStringUtil::unescapeKey(key, record.key);
+					collection[key] = std::string(record.value);
+				}
+			}
+		}
+	};
+}
+
+#endif // MINI_STATIC_H_
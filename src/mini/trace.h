@@ -0,0 +1,257 @@
+/*
+ * The MIT License (MIT)
+ * Copyright (c) 2018 Danijel Durakovic
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+///////////////////////////////////////////////////////////////////////////////
+//
+//  /mINI/ tracing
+//  Records reads and writes as Chrome trace events.
+//
+///////////////////////////////////////////////////////////////////////////////
+//
+//  When MINI_TRACE is defined, readers, writers and generators open a span
+//  around each operation and each of its phases: "io", "split", "parse",
+//  "format", "flush" and "reindex". Spans go to the sink set with
+//  INITrace::setSink(); without MINI_TRACE they are not compiled at all.
+//
+//  INIChromeTrace is a sink that keeps the spans in memory and writes them
+//  as a Chrome trace event file when flushed or destroyed. Each thread
+//  records into a buffer of its own, so traced threads don't wait for each
+//  other; flushing merges the buffers in time order. The file can be
+//  opened in Perfetto (ui.perfetto.dev) or chrome://tracing. Each span
+//  carries the number of bytes it handled, or the number of lines parsed
+//  and entries reindexed.
+//
+//  MINI_TRACE has to be defined for the whole program, for example with
+//  -DMINI_TRACE, so every file sees the same definitions. This header
+//  defines it if mini/ini.h wasn't included yet.
+//
+///////////////////////////////////////////////////////////////////////////////
+//
+//  /* BASIC USAGE EXAMPLE: */
+//
+//  /* traces everything until destroyed */
+//  mINI::INIChromeTrace trace("trace.json");
+//
+//  mINI::INIFile file("myfile.ini");
+//  file.read(ini);
+//
+//  /* write out what was traced so far */
+//  trace.flush();
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef MINI_TRACE_H_
+#define MINI_TRACE_H_
+
+#if defined(MINI_INI_H_) && !defined(MINI_TRACE)
+#error "MINI_TRACE must be defined before mini/ini.h is included"
+#endif
+#ifndef MINI_TRACE
+#define MINI_TRACE
+#endif
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include "ini.h"
+
+namespace mINI
+{
+	class INIChromeTrace : public INITraceSink
+	{
+	private:
+		using T_Clock = std::chrono::steady_clock;
+
+		struct T_Event
+		{
+			const char* name;
+			char phase;
+			std::int64_t time;
+			std::size_t thread;
+			std::size_t size;
+		};
+
+		// events of one thread; its mutex is only contended while flushing
+		struct T_Buffer
+		{
+			std::thread::id thread;
+			std::size_t index;
+			std::mutex mutex;
+			std::vector<T_Event> events;
+		};
+
+		std::filesystem::path filename;
+		T_Clock::time_point start;
+		// tells traces apart in the per-thread cache, even at the same address
+		std::uint64_t id;
+		std::mutex buffersMutex;
+		std::vector<std::unique_ptr<T_Buffer>> buffers;
+
+		static std::uint64_t nextId()
+		{
+			static std::atomic<std::uint64_t> counter{0};
+			return counter.fetch_add(1, std::memory_order_relaxed) + 1;
+		}
+		T_Buffer& getBuffer()
+		{
+			struct T_Cache
+			{
+				std::uint64_t id = 0;
+				T_Buffer* buffer = nullptr;
+			};
+			static thread_local T_Cache cache;
+			if (cache.id == id)
+			{
+				return *cache.buffer;
+			}
+			const auto thread = std::this_thread::get_id();
+			std::lock_guard<std::mutex> lock(buffersMutex);
+			auto it = std::find_if(buffers.begin(), buffers.end(), [&](auto const& buffer) {
+				return buffer->thread == thread;
+			});
+			if (it == buffers.end())
+			{
+				auto& buffer = buffers.emplace_back(std::make_unique<T_Buffer>());
+				buffer->thread = thread;
+				buffer->index = buffers.size() - 1;
+				it = buffers.end() - 1;
+			}
+			cache.id = id;
+			cache.buffer = it->get();
+			return *cache.buffer;
+		}
+		void addEvent(const char* name, char phase, std::size_t size)
+		{
+			const auto time = std::chrono::duration_cast<std::chrono::nanoseconds>(T_Clock::now() - start).count();
+			auto& buffer = getBuffer();
+			std::lock_guard<std::mutex> lock(buffer.mutex);
+			buffer.events.push_back({ name, phase, static_cast<std::int64_t>(time), buffer.index, size });
+		}
+		static void appendEvent(std::string& output, T_Event const& event)
+		{
+			output += "{\"name\":\"";
+			for (const char* c = event.name; *c != '\0'; ++c)
+			{
+				if (*c == '"' || *c == '\\')
+				{
+					output += '\\';
+				}
+				output += *c;
+			}
+			output += "\",\"cat\":\"mINI\",\"ph\":\"";
+			output += event.phase;
+			// timestamps are in microseconds
+			output += "\",\"ts\":";
+			INIStringUtil::appendNumber(output, event.time / 1000);
+			output += '.';
+			const auto fraction = static_cast<int>(event.time % 1000);
+			output += static_cast<char>('0' + fraction / 100);
+			output += static_cast<char>('0' + fraction / 10 % 10);
+			output += static_cast<char>('0' + fraction % 10);
+			output += ",\"pid\":1,\"tid\":";
+			INIStringUtil::appendNumber(output, event.thread);
+			if (event.phase == 'E')
+			{
+				output += ",\"args\":{\"size\":";
+				INIStringUtil::appendNumber(output, event.size);
+				output += '}';
+			}
+			output += '}';
+		}
+
+	public:
+		// starts tracing into filename
+		explicit INIChromeTrace(std::filesystem::path filename)
+		: filename(std::move(filename))
+		, start(T_Clock::now())
+		, id(nextId())
+		{
+			INITrace::setSink(this);
+		}
+		// stops tracing and writes the file; spans still running on other
+		// threads must have ended by now
+		~INIChromeTrace() override
+		{
+			INITraceSink* self = this;
+			INITrace::currentSink().compare_exchange_strong(self, nullptr);
+			flush();
+		}
+
+		INIChromeTrace(INIChromeTrace const&) = delete;
+		INIChromeTrace& operator=(INIChromeTrace const&) = delete;
+
+		void begin(const char* name) override
+		{
+			addEvent(name, 'B', 0);
+		}
+		void end(const char* name, std::size_t size) override
+		{
+			addEvent(name, 'E', size);
+		}
+
+		// writes all events recorded so far, replacing the file
+		bool flush()
+		{
+			std::vector<T_Event> events;
+			{
+				std::lock_guard<std::mutex> lock(buffersMutex);
+				for (auto const& buffer : buffers)
+				{
+					std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+					events.insert(events.end(), buffer->events.begin(), buffer->events.end());
+				}
+			}
+			// each buffer is in time order already, so the merge keeps every
+			// thread's begin and end events in their order
+			std::stable_sort(events.begin(), events.end(), [](T_Event const& a, T_Event const& b) {
+				return a.time < b.time;
+			});
+			std::string output = "{\"traceEvents\":[";
+			output.reserve(output.size() + events.size() * 96);
+			for (std::size_t i = 0; i < events.size(); ++i)
+			{
+				output += (i == 0) ? "\n" : ",\n";
+				appendEvent(output, events[i]);
+			}
+			output += "\n],\"displayTimeUnit\":\"ns\"}\n";
+			std::ofstream fileWriteStream(filename, std::ios::out | std::ios::binary);
+			fileWriteStream.write(output.data(), static_cast<std::streamsize>(output.size()));
+			fileWriteStream.close();
+			return !fileWriteStream.fail();
+		}
+		[[nodiscard]] std::size_t size()
+		{
+			std::lock_guard<std::mutex> lock(buffersMutex);
+			std::size_t count = 0;
+			for (auto const& buffer : buffers)
+			{
+				std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+				count += buffer->events.size();
+			}
+			return count;
+		}
+	};
+}
+
+#endif // MINI_TRACE_H_
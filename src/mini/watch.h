@@ -0,0 +1,372 @@
+/*
+ * The MIT License (MIT)
+ * Copyright (c) 2018 Danijel Durakovic
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+///////////////////////////////////////////////////////////////////////////////
+//
+//  /mINI/ file watcher
+//  Reloads INI files when they change on disk (Linux only).
+//
+///////////////////////////////////////////////////////////////////////////////
+//
+//  INIWatcher uses inotify to watch the directories of the files it is
+//  given, so in-place writes as well as atomic replacements (write to a
+//  temporary file, then rename over the original) are noticed. Events for a
+//  file are debounced: the file is read once no further events arrived for
+//  the debounce interval. It is parsed and handed to the callback only if
+//  its contents differ from the last version seen. The watcher thread
+//  sleeps in poll() while nothing happens.
+//
+//  If the kernel's event queue overflows, every watched file is read again.
+//  If a watched directory is removed, moved or replaced, the watcher tries
+//  to watch its path again every rewatch interval and reads the files in it
+//  once that succeeds.
+//
+//  Callbacks run on the watcher thread.
+//
+///////////////////////////////////////////////////////////////////////////////
+//
+//  /* BASIC USAGE EXAMPLE: */
+//
+//  mINI::INIWatcher watcher;
+//  watcher.watch("myfile.ini", [](std::filesystem::path const& filename, mINI::INIStructure const& ini) {
+//      /* apply new configuration */
+//  });
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef MINI_WATCH_H_
+#define MINI_WATCH_H_
+
+#ifdef __linux__
+
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#include "ini.h"
+
+namespace mINI
+{
+	class INIWatcher
+	{
+	public:
+		using T_Callback = std::function<void(std::filesystem::path const&, INIStructure const&)>;
+
+	private:
+		using T_Clock = std::chrono::steady_clock;
+
+		struct T_WatchedFile
+		{
+			std::filesystem::path filename;
+			std::string name;
+			// -1 while the directory isn't watched
+			int watchDescriptor;
+			T_Callback callback;
+			std::uint64_t contentsHash;
+			bool pending;
+			T_Clock::time_point deadline;
+			T_Clock::time_point rewatchTime;
+		};
+
+		static constexpr std::uint32_t eventMask =
+			IN_MODIFY | IN_CLOSE_WRITE | IN_CREATE | IN_MOVED_TO | IN_ATTRIB | IN_DELETE_SELF | IN_MOVE_SELF;
+
+		std::chrono::milliseconds debounce;
+		std::chrono::milliseconds rewatchInterval;
+		int inotifyDescriptor = -1;
+		int stopDescriptor = -1;
+		std::mutex filesMutex;
+		std::list<T_WatchedFile> files;
+		std::thread watcherThread;
+
+		static bool readContents(std::filesystem::path const& filename, std::string& contents)
+		{
+			std::ifstream fileReadStream(filename, std::ios::in | std::ios::binary);
+			if (!fileReadStream.is_open())
+			{
+				return false;
+			}
+			std::ostringstream buffer;
+			buffer << fileReadStream.rdbuf();
+			contents = buffer.str();
+			return true;
+		}
+		static int earlier(int timeout, T_Clock::time_point deadline, T_Clock::time_point now)
+		{
+			const auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now).count() + 1;
+			return (timeout < 0) ? static_cast<int>(wait) : std::min(timeout, static_cast<int>(wait));
+		}
+		static std::uint64_t hashContents(std::string_view contents)
+		{
+			std::uint64_t hash = 14695981039346656037ULL;
+			for (const char c : contents)
+			{
+				hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ULL;
+			}
+			return hash ^ contents.size();
+		}
+
+		void handleEvents()
+		{
+			alignas(inotify_event) char buffer[4096];
+			const ssize_t length = ::read(inotifyDescriptor, buffer, sizeof(buffer));
+			const auto deadline = T_Clock::now() + debounce;
+			std::lock_guard<std::mutex> lock(filesMutex);
+			for (ssize_t offset = 0; offset < length; )
+			{
+				const auto* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+				offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+				if (event->mask & IN_Q_OVERFLOW)
+				{
+					// events were dropped, so any file may have changed
+					for (auto& file : files)
+					{
+						file.pending = true;
+						file.deadline = deadline;
+					}
+					continue;
+				}
+				if (event->mask & (IN_IGNORED | IN_DELETE_SELF | IN_MOVE_SELF))
+				{
+					// the directory is gone or no longer at its path; a moved
+					// directory keeps its watch, so it is dropped here
+					if (event->mask & IN_MOVE_SELF)
+					{
+						::inotify_rm_watch(inotifyDescriptor, event->wd);
+					}
+					for (auto& file : files)
+					{
+						if (file.watchDescriptor == event->wd)
+						{
+							file.watchDescriptor = -1;
+							file.rewatchTime = T_Clock::now();
+						}
+					}
+					continue;
+				}
+				if (event->len == 0)
+				{
+					continue;
+				}
+				const std::string_view name(event->name);
+				for (auto& file : files)
+				{
+					if (file.watchDescriptor == event->wd && file.name == name)
+					{
+						file.pending = true;
+						file.deadline = deadline;
+					}
+				}
+			}
+		}
+		// reloads files whose debounce interval passed, returns time until the next deadline
+		int reloadPending()
+		{
+			std::vector<std::pair<std::filesystem::path, T_Callback>> changed;
+			std::vector<INIStructure> structures;
+			int timeout = -1;
+			{
+				std::lock_guard<std::mutex> lock(filesMutex);
+				const auto now = T_Clock::now();
+				std::string contents;
+				for (auto& file : files)
+				{
+					if (!file.pending)
+					{
+						continue;
+					}
+					if (file.deadline > now)
+					{
+						timeout = earlier(timeout, file.deadline, now);
+						continue;
+					}
+					file.pending = false;
+					if (!readContents(file.filename, contents))
+					{
+						continue;
+					}
+					const std::uint64_t contentsHash = hashContents(contents);
+					if (contentsHash == file.contentsHash)
+					{
+						continue;
+					}
+					file.contentsHash = contentsHash;
+					INIStructure data;
+					INIReader::fromString(contents) >> data;
+					changed.emplace_back(file.filename, file.callback);
+					structures.push_back(std::move(data));
+				}
+			}
+			for (std::size_t i = 0; i < changed.size(); ++i)
+			{
+				changed[i].second(changed[i].first, structures[i]);
+			}
+			return timeout;
+		}
+		// watches the directories of files that lost their watch again, returns
+		// time until the next attempt
+		int rewatchLost()
+		{
+			std::lock_guard<std::mutex> lock(filesMutex);
+			const auto now = T_Clock::now();
+			int timeout = -1;
+			for (auto& file : files)
+			{
+				if (file.watchDescriptor >= 0)
+				{
+					continue;
+				}
+				if (file.rewatchTime <= now)
+				{
+					const int watchDescriptor = ::inotify_add_watch(inotifyDescriptor, file.filename.parent_path().c_str(), eventMask);
+					if (watchDescriptor >= 0)
+					{
+						// changes made while the directory wasn't watched
+						file.watchDescriptor = watchDescriptor;
+						file.pending = true;
+						file.deadline = now + debounce;
+						continue;
+					}
+					file.rewatchTime = now + rewatchInterval;
+				}
+				timeout = earlier(timeout, file.rewatchTime, now);
+			}
+			return timeout;
+		}
+		void run()
+		{
+			pollfd descriptors[2] = {
+				{ inotifyDescriptor, POLLIN, 0 },
+				{ stopDescriptor, POLLIN, 0 }
+			};
+			int timeout = -1;
+			for (;;)
+			{
+				const int result = ::poll(descriptors, 2, timeout);
+				if (result < 0 && errno != EINTR)
+				{
+					break;
+				}
+				if (descriptors[1].revents & POLLIN)
+				{
+					break;
+				}
+				if (descriptors[0].revents & POLLIN)
+				{
+					handleEvents();
+				}
+				const int rewatchTimeout = rewatchLost();
+				timeout = reloadPending();
+				if (rewatchTimeout >= 0)
+				{
+					timeout = (timeout < 0) ? rewatchTimeout : std::min(timeout, rewatchTimeout);
+				}
+			}
+		}
+
+	public:
+		// rewatchInterval is how often a directory that was removed or
+		// replaced is looked for again
+		explicit INIWatcher(
+			std::chrono::milliseconds debounce = std::chrono::milliseconds(50),
+			std::chrono::milliseconds rewatchInterval = std::chrono::milliseconds(250)
+		)
+		: debounce(debounce)
+		, rewatchInterval(rewatchInterval)
+		{
+			inotifyDescriptor = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+			stopDescriptor = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+			if (inotifyDescriptor >= 0 && stopDescriptor >= 0)
+			{
+				watcherThread = std::thread(&INIWatcher::run, this);
+			}
+		}
+		~INIWatcher()
+		{
+			stop();
+			if (inotifyDescriptor >= 0)
+			{
+				::close(inotifyDescriptor);
+			}
+			if (stopDescriptor >= 0)
+			{
+				::close(stopDescriptor);
+			}
+		}
+
+		INIWatcher(INIWatcher const&) = delete;
+		INIWatcher& operator=(INIWatcher const&) = delete;
+
+		// starts watching a file; callback receives the new structure on every change
+		bool watch(std::filesystem::path const& filename, T_Callback callback)
+		{
+			if (!watcherThread.joinable())
+			{
+				return false;
+			}
+			const auto absolute = std::filesystem::absolute(filename);
+			const auto directory = absolute.parent_path();
+			const int watchDescriptor = ::inotify_add_watch(inotifyDescriptor, directory.c_str(), eventMask);
+			if (watchDescriptor < 0)
+			{
+				return false;
+			}
+			std::string contents;
+			const std::uint64_t contentsHash = (readContents(absolute, contents)) ? hashContents(contents) : 0;
+			std::lock_guard<std::mutex> lock(filesMutex);
+			files.push_back({
+				absolute,
+				absolute.filename().string(),
+				watchDescriptor,
+				std::move(callback),
+				contentsHash,
+				false,
+				T_Clock::time_point(),
+				T_Clock::time_point()
+			});
+			return true;
+		}
+		// stops the watcher thread; no callbacks are made after this returns
+		void stop()
+		{
+			if (watcherThread.joinable())
+			{
+				const std::uint64_t value = 1;
+				[[maybe_unused]] const auto written = ::write(stopDescriptor, &value, sizeof(value));
+				watcherThread.join();
+			}
+		}
+	};
+}
+
+#endif // __linux__
+
+#endif // MINI_WATCH_H_
@@ -0,0 +1,177 @@
+#include <iostream>
+#include <string>
+#include <sstream>
+#include <fstream>
+#include "lest.hpp"
+#include "mini/async.h"
+
+const std::string filename = "data_async.ini";
+
+const std::string original =
+	"; settings\n"
+	"[window]\n"
+	"width = 800\n"
+	"height = 600\n";
+
+//
+// helper functions
+//
+std::string readContents(std::string const& filename)
+{
+	std::ifstream fileReadStream(filename, std::ios::binary);
+	std::stringstream contents;
+	contents << fileReadStream.rdbuf();
+	return contents.str();
+}
+
+void writeContents(std::string const& filename, std::string const& contents)
+{
+	std::ofstream fileWriteStream(filename, std::ios::binary);
+	fileWriteStream << contents;
+}
+
+//
+// test cases
+//
+const lest::test mINI_tests[] = {
+	CASE("Test: Files are written like INIFile::write()")
+	{
+		writeContents(filename, original);
+		mINI::INIStructure ini;
+		EXPECT(mINI::INIFile(filename).read(ini) == true);
+		ini["window"]["width"] = "1024";
+		ini["colors"]["background"] = "black";
+		std::string expected = original;
+		EXPECT(mINI::INIWriter().update(expected, ini) == true);
+		std::filesystem::remove("data_async_new.ini");
+		std::string expectedNew;
+		mINI::INIGenerator().generate(ini, expectedNew);
+		mINI::INIAsyncWriter writer;
+		auto result = writer.write(filename, ini);
+		auto resultNew = writer.write("data_async_new.ini", ini);
+		EXPECT(result.get() == true);
+		EXPECT(resultNew.get() == true);
+		EXPECT(readContents(filename) == expected);
+		EXPECT(readContents("data_async_new.ini") == expectedNew);
+		for (auto const& entry : std::filesystem::directory_iterator("."))
+		{
+			EXPECT(entry.path().filename().string().rfind(filename + ".tmp", 0) != 0u);
+		}
+		EXPECT(writer.flush() == true);
+	},
+	CASE("Test: Repeated writes end with the last structure")
+	{
+		writeContents(filename, original);
+		mINI::INIStructure ini;
+		EXPECT(mINI::INIFile(filename).read(ini) == true);
+		std::vector<mINI::INIAsyncWriter::T_Result> results;
+		{
+			mINI::INIAsyncWriter writer;
+			for (int i = 0; i < 1000; ++i)
+			{
+				ini["window"].set("width", i);
+				results.push_back(writer.write(filename, ini));
+			}
+		}
+		for (auto const& result : results)
+		{
+			EXPECT(result.get() == true);
+		}
+		mINI::INIStructure ini2;
+		EXPECT(mINI::INIFile(filename).read(ini2) == true);
+		EXPECT(ini2["window"]["width"] == "999");
+		EXPECT(ini2["window"]["height"] == "600");
+	},
+	CASE("Test: Spellings of a path share a place in the queue")
+	{
+		writeContents(filename, original);
+		mINI::INIStructure ini;
+		EXPECT(mINI::INIFile(filename).read(ini) == true);
+		const std::string spellings[] = {
+			filename,
+			"./" + filename,
+			(std::filesystem::current_path() / filename).string(),
+			"../" + std::filesystem::current_path().filename().string() + "/" + filename
+		};
+		{
+			mINI::INIAsyncWriter writer;
+			for (int i = 0; i < 1000; ++i)
+			{
+				ini["window"].set("width", i);
+				writer.write(spellings[i % 4], ini);
+			}
+			EXPECT(writer.flush() == true);
+		}
+		mINI::INIStructure ini2;
+		EXPECT(mINI::INIFile(filename).read(ini2) == true);
+		EXPECT(ini2["window"]["width"] == "999");
+	},
+	CASE("Test: Queue is bounded")
+	{
+		mINI::INIStructure ini;
+		ini["section"]["key"] = "value";
+		mINI::INIAsyncWriter writer(2);
+		for (int i = 0; i < 50; ++i)
+		{
+			std::filesystem::remove("data_async_" + std::to_string(i) + ".ini");
+			writer.write("data_async_" + std::to_string(i) + ".ini", ini);
+		}
+		EXPECT(writer.flush() == true);
+		for (int i = 0; i < 50; ++i)
+		{
+			EXPECT(readContents("data_async_" + std::to_string(i) + ".ini") == "[section]" + std::string(mINI::INIStringUtil::endl) + "key=value");
+		}
+	},
+	CASE("Test: Failed writes are reported")
+	{
+		mINI::INIStructure ini;
+		ini["section"]["key"] = "value";
+		mINI::INIAsyncWriter writer;
+		auto result = writer.write("missing_directory/data_async.ini", ini);
+		EXPECT(result.get() == false);
+		EXPECT(writer.flush() == false);
+		EXPECT(writer.write(filename, ini).get() == true);
+		EXPECT(writer.flush() == true);
+	},
+	CASE("Test: Symlinks are kept")
+	{
+		writeContents(filename, original);
+		const std::string link = "data_async_link.ini";
+		std::filesystem::remove(link);
+		std::filesystem::create_symlink(filename, link);
+		mINI::INIStructure ini;
+		ini["window"]["width"] = "1024";
+		mINI::INIAsyncWriter writer;
+		EXPECT(writer.write(link, ini).get() == true);
+		EXPECT(std::filesystem::is_symlink(link));
+		mINI::INIStructure written;
+		EXPECT(mINI::INIFile(filename).read(written) == true);
+		EXPECT(written.get("window").get("width") == "1024");
+		std::filesystem::remove(link);
+	},
+	CASE("Test: Paths that can't be resolved fail without stopping the writer")
+	{
+		mINI::INIStructure ini;
+		ini["section"]["key"] = "value";
+		std::error_code ec;
+		std::filesystem::remove("data_async_loop", ec);
+		std::filesystem::create_symlink("data_async_loop", "data_async_loop", ec);
+		EXPECT_NOT(ec);
+		mINI::INIAsyncWriter writer;
+		EXPECT(writer.write("data_async_loop/data_async.ini", ini).get() == false);
+		EXPECT(writer.flush() == false);
+		EXPECT(writer.write(filename, ini).get() == true);
+		EXPECT(writer.flush() == true);
+		std::filesystem::remove("data_async_loop", ec);
+	}
+};
+
+int main(int argc, char** argv)
+{
+	// run tests
+	if (int failures = lest::run(mINI_tests, argc, argv))
+	{
+		return failures;
+	}
+	return std::cout << std::endl << "All tests passed!" << std::endl, EXIT_SUCCESS;
+}
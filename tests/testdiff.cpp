@@ -0,0 +1,92 @@
+#include <iostream>
+#include <string>
+#include <chrono>
+#include "lest.hpp"
+#include "mini/ini.h"
+
+using T_KeyNames = mINI::INIDiff::T_KeyNames;
+using T_SectionNames = mINI::INIDiff::T_SectionNames;
+
+const lest::test mINI_tests[] = {
+	CASE("Test: Identical structures")
+	{
+		mINI::INIStructure before;
+		before["a"]["x"] = "1";
+		before["b"];
+		mINI::INIStructure after(before);
+		mINI::INIDiff diff(before, after);
+		EXPECT(diff.empty());
+		EXPECT(diff.keysAdded.empty());
+		EXPECT(diff.keysRemoved.empty());
+		EXPECT(diff.keysChanged.empty());
+	},
+	CASE("Test: Added, removed and changed")
+	{
+		mINI::INIStructure before;
+		before["unchanged"]["k"] = "v";
+		before["keys"].set({
+			{"same", "1"},
+			{"changed", "2"},
+			{"removed", "3"}
+		});
+		before["gone"]["k"] = "v";
+		mINI::INIStructure after;
+		after["NEW"]["k"] = "v";
+		after["keys"].set({
+			{"added", "0"},
+			{"changed", "two"},
+			{"same", "1"}
+		});
+		after["unchanged"]["k"] = "v";
+		mINI::INIDiff diff(before, after);
+		EXPECT(!diff.empty());
+		EXPECT(diff.sectionsAdded == T_SectionNames({"new"}));
+		EXPECT(diff.sectionsRemoved == T_SectionNames({"gone"}));
+		EXPECT(diff.sectionsChanged == T_SectionNames({"keys"}));
+		EXPECT(diff.keysAdded == T_KeyNames({{"keys", "added"}}));
+		EXPECT(diff.keysRemoved == T_KeyNames({{"keys", "removed"}}));
+		EXPECT(diff.keysChanged == T_KeyNames({{"keys", "changed"}}));
+	},
+	CASE("Test: Removed key replaced by added key")
+	{
+		mINI::INIStructure before;
+		before["s"].set({{"a", "1"}, {"b", "2"}});
+		mINI::INIStructure after;
+		after["s"].set({{"a", "1"}, {"c", "2"}});
+		mINI::INIDiff diff(before, after);
+		EXPECT(diff.sectionsChanged == T_SectionNames({"s"}));
+		EXPECT(diff.keysAdded == T_KeyNames({{"s", "c"}}));
+		EXPECT(diff.keysRemoved == T_KeyNames({{"s", "b"}}));
+	},
+	CASE("Test: Diff a huge structure")
+	{
+		// use testdiff -t to time
+		mINI::INIStructure before;
+		for (std::size_t i = 0; i < 1000; ++i)
+		{
+			auto& collection = before["section" + std::to_string(i)];
+			for (std::size_t j = 0; j < 1000; ++j)
+			{
+				collection["key" + std::to_string(j)] = std::to_string(i * j);
+			}
+		}
+		mINI::INIStructure after(before);
+		after["section500"]["key500"] = "changed";
+		auto const start = std::chrono::steady_clock::now();
+		mINI::INIDiff diff(before, after);
+		auto const elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+		std::cout << "Diff of 1M keys took " << elapsed.count() << " ms" << std::endl;
+		EXPECT(diff.keysChanged == T_KeyNames({{"section500", "key500"}}));
+		EXPECT(diff.sectionsChanged.size() == 1U);
+	}
+};
+
+int main(int argc, char** argv)
+{
+	// run tests
+	if (int failures = lest::run(mINI_tests, argc, argv))
+	{
+		return failures;
+	}
+	return std::cout << std::endl << "All tests passed!" << std::endl, EXIT_SUCCESS;
+}
@@ -0,0 +1,232 @@
+#include <iostream>
+#include <string>
+#include <sstream>
+#include <fstream>
+#include "lest.hpp"
+#include "mini/document.h"
+
+const std::string filename = "data_document.ini";
+const std::string filenamePatch = "data_document_patch.ini";
+
+const std::string original =
+	"; settings\r\n"
+	"[window]\r\n"
+	"width  =  800   \r\n"
+	"height=600\r\n"
+	"; size in pixels\r\n"
+	"\r\n"
+	"[Colors]\r\n"
+	"GARBAGE\r\n"
+	"background = #000000\r\n"
+	"; colors end here\r\n"
+	"[window]\r\n"
+	"title = mINI";
+
+//
+// helper functions
+//
+std::string readContents(std::string const& filename)
+{
+	std::ifstream fileReadStream(filename, std::ios::binary);
+	std::stringstream contents;
+	contents << fileReadStream.rdbuf();
+	return contents.str();
+}
+
+// changes one byte of a file, keeping its size and modification time
+void changeByte(std::string const& filename, std::size_t offset, char c)
+{
+	auto const time = std::filesystem::last_write_time(filename);
+	{
+		std::fstream fileStream(filename, std::ios::in | std::ios::out | std::ios::binary);
+		fileStream.seekp(static_cast<std::streamoff>(offset));
+		fileStream.put(c);
+	}
+	std::filesystem::last_write_time(filename, time);
+}
+
+//
+// test cases
+//
+const lest::test mINI_tests[] = {
+	CASE("Test: Documents keep their contents")
+	{
+		for (auto const& contents : {original, "\xEF\xBB\xBF" + original, original + "\n", std::string()})
+		{
+			auto document = mINI::INIDocument::fromString(contents);
+			std::string output;
+			document.render(output);
+			EXPECT(output == contents);
+		}
+	},
+	CASE("Test: Read values from a document")
+	{
+		auto document = mINI::INIDocument::fromString(original);
+		EXPECT(document.size() == 2U);
+		EXPECT(document.has("WINDOW"));
+		EXPECT(document.has("colors", "Background"));
+		EXPECT(document.get("window", "width") == "800");
+		EXPECT(document.get("window", "title") == "mINI");
+		EXPECT(document.has("colors", "garbage") == false);
+		EXPECT(document.get("missing", "key").empty());
+		// same structure as reading the file
+		mINI::INIStructure ini;
+		mINI::INIStructure expected;
+		document.copyTo(ini);
+		mINI::INIReader::fromString(original) >> expected;
+		EXPECT(mINI::INIDiff(expected, ini).empty());
+	},
+	CASE("Test: Edit a document")
+	{
+		auto document = mINI::INIDocument::fromString(original);
+		document.set("window", "width", " 1024 ");
+		document.set("window", "depth", "32");
+		document.set("colors", "foreground", "#ffffff");
+		document.remove("window", "height");
+		document.set("New Section", "a=b", "c");
+		std::string output;
+		document.render(output);
+		EXPECT(output ==
+			"; settings\r\n"
+			"[window]\r\n"
+			"width  =  1024   \r\n"
+			"; size in pixels\r\n"
+			"\r\n"
+			"[Colors]\r\n"
+			"GARBAGE\r\n"
+			"background = #000000\r\n"
+			"foreground=#ffffff\r\n"
+			"; colors end here\r\n"
+			"[window]\r\n"
+			"title = mINI\r\n"
+			"depth=32\r\n"
+			"[New Section]\r\n"
+			"a\\=b=c"
+		);
+		EXPECT(document.get("new section", "a=b") == "c");
+		// removing a section takes its comments along
+		EXPECT(document.remove("colors") == true);
+		EXPECT(document.remove("colors") == false);
+		EXPECT(document.remove("window", "height") == false);
+		document.render(output);
+		EXPECT(output ==
+			"; settings\r\n"
+			"[window]\r\n"
+			"width  =  1024   \r\n"
+			"; size in pixels\r\n"
+			"\r\n"
+			"[window]\r\n"
+			"title = mINI\r\n"
+			"depth=32\r\n"
+			"[New Section]\r\n"
+			"a\\=b=c"
+		);
+	},
+	CASE("Test: Update a document from a structure")
+	{
+		auto document = mINI::INIDocument::fromString(original);
+		document.prettyPrint = true;
+		mINI::INIStructure ini;
+		document.copyTo(ini);
+		ini["window"]["title"] = "updated";
+		ini["window"].remove("width");
+		ini.remove("colors");
+		ini["fonts"]["size"] = "12";
+		document.update(ini);
+		std::string output;
+		document.render(output);
+		EXPECT(output ==
+			"; settings\r\n"
+			"[window]\r\n"
+			"height=600\r\n"
+			"; size in pixels\r\n"
+			"\r\n"
+			"[window]\r\n"
+			"title = updated\r\n"
+			"\r\n"
+			"[fonts]\r\n"
+			"size = 12"
+		);
+		mINI::INIStructure result;
+		document.copyTo(result);
+		EXPECT(mINI::INIDiff(ini, result).empty());
+	},
+	CASE("Test: Write and read a document")
+	{
+		auto document = mINI::INIDocument::fromString(original);
+		document.set("window", "width", "640");
+		EXPECT(document.write(filename) == true);
+		mINI::INIDocument copy;
+		EXPECT(copy.read(filename) == true);
+		EXPECT(copy.get("window", "width") == "640");
+		mINI::INIFile file(filename);
+		mINI::INIStructure ini;
+		EXPECT(file.read(ini) == true);
+		EXPECT(ini["window"]["width"] == "640");
+		mINI::INIDocument missing;
+		EXPECT(missing.read("missing_document.ini") == false);
+	},
+	CASE("Test: Patch a file")
+	{
+		auto document = mINI::INIDocument::fromString(original);
+		EXPECT(document.patch(filenamePatch) == true);
+		std::string output;
+		document.render(output);
+		EXPECT(readContents(filenamePatch) == output);
+		// change a byte the patch should not touch
+		changeByte(filenamePatch, 2, 'S');
+		std::string expected = output;
+		expected[2] = 'S';
+		// same length: the value is overwritten in place
+		document.set("window", "width", "900");
+		EXPECT(document.patch(filenamePatch) == true);
+		expected.replace(expected.find("800"), 3, "900");
+		EXPECT(readContents(filenamePatch) == expected);
+		// different length: the rest of the file is written from there on
+		document.set("window", "height", "1080");
+		document.remove("colors");
+		EXPECT(document.patch(filenamePatch) == true);
+		document.render(output);
+		output[2] = 'S';
+		EXPECT(readContents(filenamePatch) == output);
+		// the file changed, so it is written again as a whole
+		changeByte(filenamePatch, 2, 'X');
+		std::filesystem::last_write_time(filenamePatch, std::filesystem::file_time_type::clock::now() + std::chrono::hours(1));
+		document.set("window", "width", "901");
+		EXPECT(document.patch(filenamePatch) == true);
+		document.render(output);
+		EXPECT(readContents(filenamePatch) == output);
+	},
+	CASE("Test: Patching checks the bytes it replaces")
+	{
+		auto document = mINI::INIDocument::fromString(original);
+		EXPECT(document.write(filenamePatch) == true);
+		std::string output;
+		document.render(output);
+		// same size and time, but a byte of the line to be patched differs,
+		// so the file is written again as a whole
+		changeByte(filenamePatch, 2, 'X');
+		changeByte(filenamePatch, output.find("800") + 2, '1');
+		document.set("window", "width", "900");
+		EXPECT(document.patch(filenamePatch) == true);
+		document.render(output);
+		EXPECT(readContents(filenamePatch) == output);
+		// the same for a byte of a line that is removed
+		changeByte(filenamePatch, 2, 'X');
+		changeByte(filenamePatch, output.find("GARBAGE"), 'g');
+		document.remove("colors");
+		EXPECT(document.patch(filenamePatch) == true);
+		document.render(output);
+		EXPECT(readContents(filenamePatch) == output);
+	}
+};
+
+int main(int argc, char** argv)
+{
+	// run tests
+	if (int failures = lest::run(mINI_tests, argc, argv))
+	{
+		return failures;
+	}
+	return std::cout << std::endl << "All tests passed!" << std::endl, EXIT_SUCCESS;
+}
@@ -0,0 +1,90 @@
+#include <iostream>
+#include <string>
+#include "lest.hpp"
+#include "mini/ini.h"
+#include "testembed.ini.h"
+#include "testembed_case.ini.h"
+
+static_assert(embedded::ini.size() == 3);
+static_assert(embedded::ini.get("window").get("width") == "1024");
+
+const lest::test mINI_tests[] = {
+	CASE("Test: Embedded lookups")
+	{
+		auto const& ini = embedded::ini;
+		EXPECT(ini.has("window"));
+		EXPECT(ini.has("  Window "));
+		EXPECT(ini.has("empty"));
+		EXPECT(!ini.has("missing"));
+		EXPECT(ini.get("WINDOW").get("Width") == "1024");
+		EXPECT(ini.get("window").get("title") == "mINI = embedded");
+		EXPECT(ini.get("window").size() == 3U);
+		EXPECT(ini.get("paths").get("data=dir") == "./data");
+		EXPECT(ini.get("paths").get("log") == "\"./log?\"");
+		EXPECT(!ini.get("paths").has("width"));
+		EXPECT(!ini.get("window").has("log"));
+		EXPECT(ini.get("empty").size() == 0U);
+		EXPECT(!ini.get("missing").has("width"));
+		EXPECT(ini.get("missing").get("width").empty());
+	},
+	CASE("Test: Embedded data matches read")
+	{
+		mINI::INIFile file(TEST_EMBED_INPUT);
+		mINI::INIStructure ini;
+		EXPECT(file.read(ini));
+		EXPECT(ini.size() == embedded::ini.size());
+		auto it = embedded::ini.begin();
+		for (auto const& section : ini)
+		{
+			EXPECT(section.first == it->name);
+			auto embeddedSection = embedded::ini.get(it->name);
+			EXPECT(section.second.size() == embeddedSection.size());
+			auto it2 = embeddedSection.begin();
+			for (auto const& key : section.second)
+			{
+				EXPECT(key.first == it2->key);
+				EXPECT(key.second == it2->value);
+				++it2;
+			}
+			++it;
+		}
+		for (auto const& section : embedded::ini)
+		{
+			for (auto const& key : embedded::ini.get(section.name))
+			{
+				EXPECT(embedded::ini.get(section.name).get(key.key) == key.value);
+			}
+		}
+		mINI::INIStructure copy;
+		embedded::ini.copyTo(copy);
+		EXPECT(copy.get("window").get("width") == "1024");
+	},
+	CASE("Test: Case sensitive embedded lookups")
+	{
+		auto const& ini = embeddedCase::ini;
+		EXPECT(ini.size() == 4U);
+		EXPECT(ini.has("Window"));
+		EXPECT(ini.has("WINDOW"));
+		EXPECT(!ini.has("window"));
+		EXPECT(ini.get("Window").get("Width") == "800");
+		EXPECT(!ini.get("Window").has("width"));
+		EXPECT(ini.get("WINDOW").get("width") == "1024");
+		for (auto const& section : ini)
+		{
+			for (auto const& key : ini.get(section.name))
+			{
+				EXPECT(ini.get(section.name).get(key.key) == key.value);
+			}
+		}
+	}
+};
+
+int main(int argc, char** argv)
+{
+	// run tests
+	if (int failures = lest::run(mINI_tests, argc, argv))
+	{
+		return failures;
+	}
+	return std::cout << std::endl << "All tests passed!" << std::endl, EXIT_SUCCESS;
+}
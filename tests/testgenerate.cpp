@@ -3,6 +3,7 @@
 #include <vector>
 #include <utility>
 #include <fstream>
+#include <sstream>
 #include "lest.hpp"
 #include "mini/ini.h"
 
@@ -164,6 +165,20 @@ const T_INIFileData testDataMalformed2 = {
 	}
 };
 
+const T_INIFileData testDataTyped = {
+	// filename
+	"data10.ini",
+	// test data
+	{
+		"[counters]",
+		"requests=1000",
+		"errors=-3",
+		"ratio=0.25",
+		"enabled=true",
+		"uptime=18446744073709551615"
+	}
+};
+
 //
 // test cases
 //
@@ -272,6 +287,63 @@ const lest::test mINI_tests[] = {
 		});
 		EXPECT(file.generate(ini) == true);
 		EXPECT(verifyData(testDataMalformed2));
+	},
+	CASE("Test: Generate typed values")
+	{
+		std::string const& filename = testDataTyped.first;
+		mINI::INIFile file(filename);
+		mINI::INIStructure ini;
+		auto& counters = ini["counters"];
+		for (int i = 1; i <= 1000; ++i)
+		{
+			counters.set("requests", i);
+		}
+		counters.set("errors", -3);
+		counters.set("ratio", 0.25);
+		counters.set("enabled", true);
+		counters.set("uptime", static_cast<unsigned long long>(-1));
+		EXPECT(counters.get("requests") == "1000");
+		EXPECT(file.generate(ini) == true);
+		EXPECT(verifyData(testDataTyped));
+	},
+	CASE("Test: Generate to memory")
+	{
+		mINI::INIStructure ini;
+		ini["section1"].set({
+			{"key1", "value1"},
+			{"key2", "value2"},
+		});
+		ini["section2"]["key1"] = "value1";
+		ini["name"]["a= ="] = "  =b  ";
+		for (bool pretty : {false, true})
+		{
+			std::string const filename = "data11.ini";
+			mINI::INIFile file(filename);
+			EXPECT(file.generate(ini, pretty) == true);
+			std::ifstream fileReadStream(filename, std::ios::binary);
+			std::stringstream expected;
+			expected << fileReadStream.rdbuf();
+			mINI::INIGenerator generator;
+			generator.prettyPrint = pretty;
+			// string
+			std::string output = "old contents";
+			EXPECT(generator.generate(ini, output) == true);
+			EXPECT(output == expected.str());
+			EXPECT(generator.outputSize == output.size());
+			// stream
+			std::stringstream stream;
+			EXPECT(generator.generate(ini, stream) == true);
+			EXPECT(stream.str() == expected.str());
+			// buffer
+			std::vector<char> buffer(output.size());
+			EXPECT(generator.generate(ini, buffer.data(), buffer.size()) == true);
+			EXPECT(std::string(buffer.begin(), buffer.end()) == expected.str());
+			EXPECT(generator.generate(ini, buffer.data(), buffer.size() - 1) == false);
+			EXPECT(generator.outputSize == output.size());
+		}
+		// a generator without a file can't be used with <<
+		mINI::INIGenerator generator;
+		EXPECT((generator << ini) == false);
 	}
 };
 
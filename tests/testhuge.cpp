@@ -1,9 +1,35 @@
 /* use testhuge -t to time tests */
 
 #include <iostream>
+#include <atomic>
+#include <cstdlib>
+#include <new>
 #include "lest.hpp"
 #include "mini/ini.h"
 
+// counts heap allocations made by the tests
+std::atomic<std::size_t> allocationCount{0};
+
+void* operator new(std::size_t size)
+{
+	++allocationCount;
+	if (void* ptr = std::malloc(size ? size : 1))
+	{
+		return ptr;
+	}
+	throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+	std::free(ptr);
+}
+
 const std::string filename = "data_huge.ini";
 
 const size_t N_sections = 20;
@@ -29,8 +55,11 @@ const lest::test mINI_tests[] = {
 				ini[section][key] = value;
 			}
 		}
-		// generate file
+		// generate file; the output is rendered into a single buffer, so
+		// the number of allocations doesn't depend on the number of keys
+		std::size_t const allocationsBefore = allocationCount;
 		EXPECT(file.generate(ini) == true);
+		EXPECT(allocationCount - allocationsBefore < 16U);
 	},
 	CASE("TEST: Read a huge file")
 	{
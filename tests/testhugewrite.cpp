@@ -0,0 +1,86 @@
+/* use testhugewrite -t to time tests */
+
+#include <iostream>
+#include <chrono>
+#include "lest.hpp"
+#include "mini/ini.h"
+
+const std::string filename = "data_huge_write.ini";
+
+const size_t N_items_per_section = 100;
+
+// write() on files of increasing size; each section gets a changed value, a
+// removed key and a new key so every branch of the lazy writer is exercised
+double timeLazyWrite(size_t lines)
+{
+	const size_t N_sections = lines / (N_items_per_section + 1);
+	mINI::INIStructure ini;
+	for (size_t i = 1; i <= N_sections; ++i)
+	{
+		auto& collection = ini["section" + std::to_string(i)];
+		for (size_t j = 1; j <= N_items_per_section; ++j)
+		{
+			collection["key" + std::to_string(j)] = "value" + std::to_string(j);
+		}
+	}
+	mINI::INIFile file(filename);
+	if (!file.generate(ini))
+	{
+		return -1.0;
+	}
+	for (size_t i = 1; i <= N_sections; ++i)
+	{
+		auto& collection = ini["section" + std::to_string(i)];
+		collection["key1"] = "changed";
+		collection.remove("key2");
+		collection["added"] = "value";
+	}
+	auto const start = std::chrono::steady_clock::now();
+	if (!file.write(ini))
+	{
+		return -1.0;
+	}
+	std::chrono::duration<double> const elapsed = std::chrono::steady_clock::now() - start;
+	return elapsed.count();
+}
+
+const lest::test mINI_tests[] = {
+	CASE("TEST: Lazy write scales linearly")
+	{
+		double const time250k = timeLazyWrite(250000);
+		double const time1M = timeLazyWrite(1000000);
+		EXPECT(time250k > 0.0);
+		EXPECT(time1M > 0.0);
+		std::cout << "write() on 250k lines: " << time250k << " s" << std::endl;
+		std::cout << "write() on 1M lines: " << time1M << " s" << std::endl;
+		// four times the lines should take about four times as long; allow
+		// plenty of headroom for noise, a quadratic writer needs ~16x
+		EXPECT(time1M < time250k * 10.0);
+	},
+	CASE("TEST: Lazy write result of a huge file")
+	{
+		// this testcase relies on the previous test passing
+		mINI::INIFile file(filename);
+		mINI::INIStructure ini;
+		EXPECT(file.read(ini) == true);
+		EXPECT(ini.size() == 1000000 / (N_items_per_section + 1));
+		for (auto const& it : ini)
+		{
+			auto const& collection = it.second;
+			EXPECT(collection.size() == N_items_per_section);
+			EXPECT(collection.get("key1") == "changed");
+			EXPECT(collection.has("key2") == false);
+			EXPECT(collection.get("added") == "value");
+		}
+	}
+};
+
+int main(int argc, char** argv)
+{
+	// run tests
+	if (int failures = lest::run(mINI_tests, argc, argv))
+	{
+		return failures;
+	}
+	return std::cout << std::endl << "All tests passed!" << std::endl, EXIT_SUCCESS;
+}
@@ -0,0 +1,259 @@
+#include <iostream>
+#include <string>
+#include <sstream>
+#include <fstream>
+#include <cstdio>
+#include "lest.hpp"
+#include "mini/journal.h"
+
+const std::string filename = "data_journal.ini";
+
+//
+// helper functions
+//
+std::string readContents(std::string const& filename)
+{
+	std::ifstream fileReadStream(filename, std::ios::binary);
+	std::stringstream contents;
+	contents << fileReadStream.rdbuf();
+	return contents.str();
+}
+
+void writeContents(std::string const& filename, std::string const& contents)
+{
+	std::ofstream fileWriteStream(filename, std::ios::binary);
+	fileWriteStream << contents;
+}
+
+std::string generate(mINI::INIStructure const& ini)
+{
+	std::string output;
+	mINI::INIGenerator generator;
+	generator.generate(ini, output);
+	if (!output.empty())
+	{
+		output += mINI::INIStringUtil::endl;
+	}
+	return output;
+}
+
+bool equal(mINI::INIStructure const& a, mINI::INIStructure const& b)
+{
+	return mINI::INIDiff(a, b).empty();
+}
+
+const std::string endl = mINI::INIStringUtil::endl;
+
+// lines framed the way the journal appends them
+std::string batch(std::string const& body)
+{
+	std::uint64_t hash = 14695981039346656037ULL;
+	for (const char c : body)
+	{
+		hash ^= static_cast<unsigned char>(c);
+		hash *= 1099511628211ULL;
+	}
+	char hex[17];
+	std::snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(hash));
+	return ";mINI:begin" + endl + body + ";mINI:commit " + std::to_string(body.size()) + " " + hex + endl;
+}
+
+//
+// test cases
+//
+const lest::test mINI_tests[] = {
+	CASE("Test: Changes are appended")
+	{
+		writeContents(filename, "[fruit]" + endl + "apple=red" + endl);
+		mINI::INIJournal journal(filename);
+		mINI::INIStructure ini;
+		EXPECT(journal.read(ini) == true);
+		EXPECT(ini["fruit"]["apple"] == "red");
+		ini["fruit"]["apple"] = "green";
+		ini["fruit"]["pear=s"] = "yellow";
+		ini["vegetables"]["carrot"] = "orange";
+		ini["empty"];
+		EXPECT(journal.write(ini) == true);
+		EXPECT(readContents(filename) == (
+			"[fruit]" + endl + "apple=red" + endl + batch(
+				"[fruit]" + endl + "apple=green" + endl + "pear\\=s=yellow" + endl +
+				"[vegetables]" + endl + "carrot=orange" + endl +
+				"[empty]" + endl
+			)
+		));
+		// nothing changed, nothing written
+		EXPECT(journal.write(ini) == true);
+		// the last section written needs no header
+		ini["vegetables"]["potato"] = "brown";
+		EXPECT(journal.write(ini) == true);
+		const std::string contents = readContents(filename);
+		const std::string tail = batch("[vegetables]" + endl + "potato=brown" + endl);
+		EXPECT(contents.substr(contents.size() - tail.size()) == tail);
+		ini["vegetables"]["onion"] = "white";
+		EXPECT(journal.write(ini) == true);
+		EXPECT(readContents(filename) == contents + batch("onion=white" + endl));
+		// the file reads back as the structure
+		mINI::INIStructure ini2;
+		EXPECT(mINI::INIFile(filename).read(ini2) == true);
+		EXPECT(equal(ini, ini2));
+	},
+	CASE("Test: Changes through references are appended")
+	{
+		writeContents(filename, "");
+		mINI::INIJournal journal(filename);
+		mINI::INIStructure ini;
+		EXPECT(journal.read(ini) == true);
+		auto& value = ini["s"]["k"];
+		value = "1";
+		EXPECT(journal.write(ini) == true);
+		value = "2";
+		EXPECT(journal.write(ini) == true);
+		mINI::INIStructure ini2;
+		EXPECT(mINI::INIFile(filename).read(ini2) == true);
+		EXPECT(ini2.get("s").get("k") == "2");
+		// keys that were only read are not appended again
+		const std::string contents = readContents(filename);
+		EXPECT(ini["s"]["k"] == "2");
+		EXPECT(journal.write(ini) == true);
+		EXPECT(readContents(filename) == contents);
+	},
+	CASE("Test: Removing compacts the file")
+	{
+		writeContents(filename, "[a]" + endl + "x=1" + endl + "[b]" + endl + "y=2" + endl);
+		mINI::INIJournal journal(filename);
+		mINI::INIStructure ini;
+		EXPECT(journal.read(ini) == true);
+		ini["a"]["x"] = "3";
+		EXPECT(journal.write(ini) == true);
+		ini["b"].remove("y");
+		EXPECT(journal.write(ini) == true);
+		EXPECT(readContents(filename) == generate(ini));
+		ini.remove("a");
+		ini["c"]["z"] = "4";
+		EXPECT(journal.write(ini) == true);
+		EXPECT(readContents(filename) == generate(ini));
+		// appending continues after a compaction
+		const std::string compacted = readContents(filename);
+		ini["c"]["w"] = "5";
+		EXPECT(journal.write(ini) == true);
+		EXPECT(readContents(filename) == compacted + batch("w=5" + endl));
+		// a replaced section is compared key by key
+		ini["b"] = ini["c"];
+		EXPECT(journal.write(ini) == true);
+		EXPECT(readContents(filename) == compacted + batch("w=5" + endl) + batch("[b]" + endl + "z=4" + endl + "w=5" + endl));
+		ini["c"] = mINI::INIMap<std::string>();
+		EXPECT(journal.write(ini) == true);
+		EXPECT(readContents(filename) == generate(ini));
+	},
+	CASE("Test: Files without a final line break are kept")
+	{
+		const std::string original = "[s]" + endl + "a=1" + endl + "b=2";
+		writeContents(filename, original);
+		mINI::INIJournal journal(filename);
+		mINI::INIStructure ini;
+		EXPECT(journal.read(ini) == true);
+		EXPECT(ini.get("s").get("b") == "2");
+		EXPECT(readContents(filename) == original);
+		ini["s"]["c"] = "3";
+		EXPECT(journal.write(ini) == true);
+		EXPECT(readContents(filename) == original + endl + batch("[s]" + endl + "c=3" + endl));
+		mINI::INIJournal journal2(filename);
+		mINI::INIStructure ini2;
+		EXPECT(journal2.read(ini2) == true);
+		EXPECT(equal(ini, ini2));
+	},
+	CASE("Test: Batches that were not committed are skipped")
+	{
+		const std::string torn =
+			"[a]" + endl + "x=1" + endl +
+			batch("[a]" + endl + "y=2" + endl) +
+			// wrong hash
+			";mINI:begin" + endl + "[a]" + endl + "x=10" + endl + ";mINI:commit 10 0000000000000000" + endl +
+			batch("[b]" + endl + "z=3" + endl) +
+			// interrupted
+			";mINI:begin" + endl + "[a]" + endl + "x=20" + endl + "w=";
+		writeContents(filename, torn);
+		mINI::INIJournal journal(filename);
+		mINI::INIStructure ini;
+		EXPECT(journal.read(ini) == true);
+		EXPECT(ini.get("a").get("x") == "1");
+		EXPECT(ini.get("a").get("y") == "2");
+		EXPECT_NOT(ini.get("a").has("w"));
+		EXPECT(ini.get("b").get("z") == "3");
+		// nothing is cut off the file
+		EXPECT(readContents(filename) == torn);
+		// the next write starts over from the structure
+		ini["a"]["v"] = "4";
+		EXPECT(journal.write(ini) == true);
+		EXPECT(readContents(filename) == generate(ini));
+		// other readers ignore the frames
+		writeContents(filename, "[a]" + endl + "x=1" + endl + batch("[a]" + endl + "y=2" + endl));
+		mINI::INIStructure ini2;
+		EXPECT(mINI::INIFile(filename).read(ini2) == true);
+		EXPECT(ini2.get("a").get("y") == "2");
+		EXPECT(ini2.get("a").size() == 2u);
+	},
+	CASE("Test: Journal is compacted once it grows")
+	{
+		writeContents(filename, "");
+		mINI::INIJournal journal(filename);
+		journal.compactionThreshold = 256;
+		mINI::INIStructure ini;
+		EXPECT(journal.read(ini) == true);
+		for (int i = 0; i < 1000; ++i)
+		{
+			ini["counter"].set("value", i);
+			ini["counter"].set("key" + std::to_string(i % 10), i);
+			EXPECT(journal.write(ini) == true);
+		}
+		EXPECT(readContents(filename).size() < 1024u);
+		mINI::INIStructure ini2;
+		EXPECT(journal.read(ini2) == true);
+		EXPECT(equal(ini, ini2));
+	},
+	CASE("Test: Other files and structures are compacted")
+	{
+		writeContents(filename, "[a]" + endl + "x=1" + endl);
+		mINI::INIJournal journal(filename);
+		mINI::INIStructure ini;
+		EXPECT(journal.read(ini) == true);
+		// a structure the journal didn't read
+		mINI::INIStructure other = ini;
+		other["a"]["y"] = "2";
+		EXPECT(journal.write(other) == true);
+		EXPECT(readContents(filename) == generate(other));
+		// the file was replaced by someone else
+		writeContents(filename, "[b]" + endl + "z=3" + endl + endl + endl);
+		other["a"]["y"] = "4";
+		EXPECT(journal.write(other) == true);
+		EXPECT(readContents(filename) == generate(other));
+		// a symlinked journal stays a link
+		const std::string link = "data_journal_link.ini";
+		std::filesystem::remove(link);
+		std::filesystem::create_symlink(filename, link);
+		mINI::INIJournal linked(link);
+		EXPECT(linked.read(other) == true);
+		other["a"].remove("y");
+		EXPECT(linked.write(other) == true);
+		EXPECT(std::filesystem::is_symlink(link));
+		EXPECT(readContents(filename) == generate(other));
+		std::filesystem::remove(link);
+		// missing files are created
+		std::filesystem::remove(filename);
+		mINI::INIJournal journal2(filename);
+		EXPECT(journal2.read(ini) == false);
+		ini["a"]["x"] = "1";
+		EXPECT(journal2.write(ini) == true);
+		EXPECT(readContents(filename) == generate(ini));
+	}
+};
+
+int main(int argc, char** argv)
+{
+	// run tests
+	if (int failures = lest::run(mINI_tests, argc, argv))
+	{
+		return failures;
+	}
+	return std::cout << std::endl << "All tests passed!" << std::endl, EXIT_SUCCESS;
+}
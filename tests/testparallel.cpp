@@ -0,0 +1,79 @@
+/* use testparallel -t to time tests */
+
+#include <iostream>
+#include <chrono>
+#include "lest.hpp"
+#include "mini/parallel.h"
+
+const std::string filename = "data_parallel.ini";
+
+// sections of very different sizes, so ranges can't just split evenly
+mINI::INIStructure makeStructure(std::size_t sections)
+{
+	mINI::INIStructure ini;
+	for (std::size_t i = 0; i < sections; ++i)
+	{
+		auto& collection = ini["section" + std::to_string(i)];
+		const std::size_t keys = (i % 7 == 0) ? 2000 : i % 13;
+		for (std::size_t j = 0; j < keys; ++j)
+		{
+			collection["key" + std::to_string(j) + ((j % 5 == 0) ? "=" : "")] = " value" + std::to_string(i * j) + " ";
+		}
+	}
+	return ini;
+}
+
+const lest::test mINI_tests[] = {
+	CASE("Test: Parallel output is identical to sequential output")
+	{
+		for (std::size_t sections : {0, 1, 2, 3, 50, 400})
+		{
+			auto const ini = makeStructure(sections);
+			for (bool pretty : {false, true})
+			{
+				mINI::INIGenerator generator;
+				generator.prettyPrint = pretty;
+				std::string expected;
+				generator.generate(ini, expected);
+				for (std::size_t threads : {1, 2, 3, 8, 64})
+				{
+					mINI::INIParallelGenerator parallelGenerator;
+					parallelGenerator.prettyPrint = pretty;
+					parallelGenerator.threadCount = threads;
+					std::string output;
+					EXPECT(parallelGenerator.generate(ini, output) == true);
+					EXPECT(output == expected);
+					EXPECT(parallelGenerator.outputSize == expected.size());
+				}
+			}
+		}
+	},
+	CASE("Test: Parallel generate a huge file")
+	{
+		auto const ini = makeStructure(2000);
+		auto start = std::chrono::steady_clock::now();
+		mINI::INIFile file(filename);
+		EXPECT(file.generate(ini) == true);
+		std::chrono::duration<double> const sequential = std::chrono::steady_clock::now() - start;
+		start = std::chrono::steady_clock::now();
+		mINI::INIParallelGenerator generator(filename);
+		EXPECT((generator << ini) == true);
+		std::chrono::duration<double> const parallel = std::chrono::steady_clock::now() - start;
+		std::cout << "Sequential: " << sequential.count() << " s" << std::endl;
+		std::cout << "Parallel (" << generator.threadCount << " threads): " << parallel.count() << " s" << std::endl;
+		mINI::INIStructure result;
+		EXPECT(file.read(result) == true);
+		EXPECT(mINI::INIDiff(result, ini).keysAdded.empty());
+		EXPECT(result.size() == ini.size());
+	}
+};
+
+int main(int argc, char** argv)
+{
+	// run tests
+	if (int failures = lest::run(mINI_tests, argc, argv))
+	{
+		return failures;
+	}
+	return std::cout << std::endl << "All tests passed!" << std::endl, EXIT_SUCCESS;
+}
@@ -0,0 +1,266 @@
+/* fits how the time of each operation grows with its input size */
+
+#include <iostream>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <vector>
+#include "lest.hpp"
+#include "mini/ini.h"
+
+// inputs double this many times from the smallest size
+const std::size_t N_steps = 4;
+const std::size_t N_repeats = 3;
+
+// exponent of the fitted power law; linear growth is 1, quadratic 2
+const double max_exponent = 1.5;
+
+//
+// helper functions
+//
+template<typename T_Function>
+double seconds(T_Function&& function)
+{
+	const auto start = std::chrono::steady_clock::now();
+	function();
+	const auto end = std::chrono::steady_clock::now();
+	return std::chrono::duration<double>(end - start).count();
+}
+
+// operation(n) prepares an input of size n and returns the time taken on it;
+// the fastest of a few runs per size is fitted on a log-log scale
+template<typename T_Operation>
+double growthExponent(std::size_t firstSize, T_Operation&& operation)
+{
+	std::vector<double> x;
+	std::vector<double> y;
+	for (std::size_t i = 0, n = firstSize; i < N_steps; ++i, n *= 2)
+	{
+		double best = std::numeric_limits<double>::max();
+		for (std::size_t j = 0; j < N_repeats; ++j)
+		{
+			best = std::min(best, operation(n));
+		}
+		x.push_back(std::log(static_cast<double>(n)));
+		y.push_back(std::log(std::max(best, 1e-9)));
+	}
+	double meanX = 0;
+	double meanY = 0;
+	for (std::size_t i = 0; i < x.size(); ++i)
+	{
+		meanX += x[i] / static_cast<double>(x.size());
+		meanY += y[i] / static_cast<double>(y.size());
+	}
+	double covariance = 0;
+	double variance = 0;
+	for (std::size_t i = 0; i < x.size(); ++i)
+	{
+		covariance += (x[i] - meanX) * (y[i] - meanY);
+		variance += (x[i] - meanX) * (x[i] - meanX);
+	}
+	return covariance / variance;
+}
+
+// n keys, 100 to a section
+std::string makeContents(std::size_t n)
+{
+	std::string contents;
+	for (std::size_t i = 0; i < n; ++i)
+	{
+		if (i % 100 == 0)
+		{
+			contents += "[section" + std::to_string(i / 100) + "]\n";
+		}
+		contents += "key" + std::to_string(i) + " = value" + std::to_string(i) + "\n";
+	}
+	return contents;
+}
+
+mINI::INIStructure parse(std::string const& contents)
+{
+	mINI::INIStructure ini;
+	mINI::INIReader::fromString(contents) >> ini;
+	return ini;
+}
+
+//
+// test cases
+//
+const lest::test mINI_tests[] = {
+	CASE("Test: Read is linear")
+	{
+		const double exponent = growthExponent(25000, [](std::size_t n) {
+			const std::string contents = makeContents(n);
+			mINI::INIStructure ini;
+			return seconds([&] { mINI::INIReader::fromString(contents) >> ini; });
+		});
+		EXPECT(exponent < max_exponent);
+	},
+	CASE("Test: Generate is linear")
+	{
+		const double exponent = growthExponent(25000, [](std::size_t n) {
+			const auto ini = parse(makeContents(n));
+			std::string output;
+			return seconds([&] { mINI::INIGenerator().generate(ini, output); });
+		});
+		EXPECT(exponent < max_exponent);
+	},
+	CASE("Test: Write is linear")
+	{
+		const double exponent = growthExponent(25000, [](std::size_t n) {
+			std::string contents = makeContents(n);
+			auto ini = parse(contents);
+			for (std::size_t i = 0; i < n; i += 10)
+			{
+				ini["section" + std::to_string(i / 100)]["key" + std::to_string(i)] = "changed";
+			}
+			return seconds([&] { mINI::INIWriter().update(contents, ini); });
+		});
+		EXPECT(exponent < max_exponent);
+	},
+	CASE("Test: Write with new keys and sections is linear")
+	{
+		const double exponent = growthExponent(25000, [](std::size_t n) {
+			std::string contents = makeContents(n);
+			auto ini = parse(contents);
+			for (std::size_t i = 0; i < n / 2; ++i)
+			{
+				ini["section0"]["new key" + std::to_string(i)] = "value";
+			}
+			for (std::size_t i = 0; i < n / 100; ++i)
+			{
+				ini["new section" + std::to_string(i)]["key"] = "value";
+			}
+			return seconds([&] { mINI::INIWriter().update(contents, ini); });
+		});
+		EXPECT(exponent < max_exponent);
+	},
+	CASE("Test: Removing a key is linear in the size of the map")
+	{
+		// entries after a removed key move down, so each removal from the
+		// front touches the whole map; removed keys are added back at the end
+		// to keep the size, and sizes stay small enough to fit in the cache
+		const double exponent = growthExponent(1000, [](std::size_t n) {
+			mINI::INIMap<std::string> collection;
+			std::vector<std::string> keys;
+			for (std::size_t i = 0; i < n; ++i)
+			{
+				keys.push_back("key" + std::to_string(i));
+				collection[keys.back()] = "value";
+			}
+			return seconds([&] {
+				for (std::size_t i = 0; i < 1000; ++i)
+				{
+					collection.remove(keys[i % n]);
+					collection[keys[i % n]] = "value";
+				}
+			});
+		});
+		EXPECT(exponent < max_exponent);
+	},
+	CASE("Test: Removing a section is linear in the number of sections")
+	{
+		const double exponent = growthExponent(500, [](std::size_t n) {
+			mINI::INIStructure ini;
+			std::vector<std::string> sections;
+			for (std::size_t i = 0; i < n; ++i)
+			{
+				sections.push_back("section" + std::to_string(i));
+				ini[sections.back()]["key"] = "value";
+			}
+			return seconds([&] {
+				for (std::size_t i = 0; i < 200; ++i)
+				{
+					ini.remove(sections[i % n]);
+					ini[sections[i % n]]["key"] = "value";
+				}
+			});
+		});
+		EXPECT(exponent < max_exponent);
+	},
+	CASE("Test: Removing half the keys one at a time is quadratic")
+	{
+		// a known superlinear case: every removal moves the entries after it,
+		// so removing a fraction of the keys costs O(n) per key and O(n^2) in
+		// total. This checks that the harness sees it; building a new map
+		// from the keys to keep is linear instead
+		const double exponent = growthExponent(1000, [](std::size_t n) {
+			mINI::INIMap<std::string> collection;
+			std::vector<std::string> keys;
+			for (std::size_t i = 0; i < n; ++i)
+			{
+				keys.push_back("key" + std::to_string(i));
+				collection[keys.back()] = "value";
+			}
+			return seconds([&] {
+				for (std::size_t i = 0; i < n / 2; ++i)
+				{
+					collection.remove(keys[i]);
+				}
+			});
+		});
+		EXPECT(exponent > max_exponent);
+	},
+	CASE("Test: Long runs of escaped keys are linear")
+	{
+		const double exponent = growthExponent(65536, [](std::size_t n) {
+			std::string key;
+			for (std::size_t i = 0; i < n; ++i)
+			{
+				key += "\\=";
+			}
+			std::string contents = "[section]\n" + key + "=value\n";
+			return seconds([&] {
+				auto ini = parse(contents);
+				ini["section"]["new"] = "value";
+				mINI::INIWriter().update(contents, ini);
+			});
+		});
+		EXPECT(exponent < max_exponent);
+	},
+	CASE("Test: Megabyte lines are linear")
+	{
+		// up to 1 MB per line
+		const double exponent = growthExponent(131072, [](std::size_t n) {
+			std::string contents = "[section]\n";
+			for (std::size_t i = 0; i < 8; ++i)
+			{
+				contents += "key" + std::to_string(i) + " = " + std::string(n, 'a' + static_cast<char>(i)) + "\n";
+			}
+			return seconds([&] {
+				auto ini = parse(contents);
+				ini["section"]["key0"] = "changed";
+				mINI::INIWriter().update(contents, ini);
+			});
+		});
+		EXPECT(exponent < max_exponent);
+	},
+	CASE("Test: Many empty sections are linear")
+	{
+		// up to 1M sections, the size the pathological inputs call for; this
+		// is the slowest case of the suite at about 20 seconds
+		const double exponent = growthExponent(131072, [](std::size_t n) {
+			std::string contents;
+			for (std::size_t i = 0; i < n; ++i)
+			{
+				contents += "[" + std::to_string(i) + "]\n";
+			}
+			return seconds([&] {
+				auto ini = parse(contents);
+				ini["new section"]["key"] = "value";
+				mINI::INIWriter().update(contents, ini);
+			});
+		});
+		EXPECT(exponent < max_exponent);
+	}
+};
+
+int main(int argc, char** argv)
+{
+	// run tests
+	if (int failures = lest::run(mINI_tests, argc, argv))
+	{
+		return failures;
+	}
+	return std::cout << std::endl << "All tests passed!" << std::endl, EXIT_SUCCESS;
+}
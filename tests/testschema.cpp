@@ -0,0 +1,166 @@
+#include <iostream>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include "lest.hpp"
+#include "mini/schema.h"
+
+struct Settings
+{
+	int width;
+	int height;
+	double scale;
+	bool fullscreen;
+	std::string title;
+	unsigned long long seed;
+};
+
+constexpr mINI::INISchema settingsSchema {
+	mINI::INIField("window", "width", &Settings::width, 800),
+	mINI::INIField("window", "height", &Settings::height, 600),
+	mINI::INIField("window", "scale", &Settings::scale, 1.0),
+	mINI::INIField("window", "fullscreen", &Settings::fullscreen, false),
+	mINI::INIField("Window", "Title", &Settings::title, "untitled"),
+	mINI::INIField("random", "seed", &Settings::seed, 42ULL)
+};
+
+static_assert(settingsSchema.fieldCount == 6);
+
+std::string readTestFile(std::string const& filename)
+{
+	std::ifstream fileReadStream(filename, std::ios::in | std::ios::binary);
+	std::ostringstream contents;
+	contents << fileReadStream.rdbuf();
+	return contents.str();
+}
+
+bool writeTestFile(std::string const& filename, std::string const& contents)
+{
+	std::ofstream fileWriteStream(filename, std::ios::out | std::ios::binary);
+	if (!fileWriteStream.is_open())
+	{
+		return false;
+	}
+	fileWriteStream << contents;
+	return true;
+}
+
+const lest::test mINI_tests[] = {
+	CASE("Test: Read into struct")
+	{
+		const std::string filename = "schema01.ini";
+		EXPECT(writeTestFile(filename,
+			"; window settings\n"
+			"[WINDOW]\n"
+			"width = 1920\n"
+			"  Height=1080  \n"
+			"scale=+1.5\n"
+			"fullscreen = yes\n"
+			"title = My Game = Best Game\n"
+			"[random]\n"
+			"seed=18446744073709551615\n"
+		));
+		Settings settings;
+		auto report = settingsSchema.read(filename, settings);
+		EXPECT(report.complete());
+		EXPECT(settings.width == 1920);
+		EXPECT(settings.height == 1080);
+		EXPECT(settings.scale == 1.5);
+		EXPECT(settings.fullscreen == true);
+		EXPECT(settings.title == "My Game = Best Game");
+		EXPECT(settings.seed == 18446744073709551615ULL);
+	},
+	CASE("Test: Missing, unknown and invalid keys")
+	{
+		const std::string filename = "schema02.ini";
+		EXPECT(writeTestFile(filename,
+			"width=10\n"
+			"[window]\n"
+			"width=abc\n"
+			"height=720\n"
+			"depth=32\n"
+			"[other]\n"
+			"seed=1\n"
+		));
+		Settings settings;
+		auto report = settingsSchema.read(filename, settings);
+		EXPECT(report.readSuccess);
+		EXPECT(!report.complete());
+		EXPECT(settings.width == 800);
+		EXPECT(settings.height == 720);
+		EXPECT(settings.title == "untitled");
+		EXPECT(settings.seed == 42ULL);
+		EXPECT(report.invalid.size() == 1U);
+		EXPECT(report.invalid[0].second == "width");
+		EXPECT(report.unknown.size() == 2U);
+		EXPECT(report.unknown[0].second == "depth");
+		EXPECT(report.unknown[1].first == "other");
+		EXPECT(report.missing.size() == 4U);
+	},
+	CASE("Test: Read missing file")
+	{
+		Settings settings;
+		auto report = settingsSchema.read("schema_nonexistent.ini", settings);
+		EXPECT(!report.readSuccess);
+		EXPECT(report.missing.size() == settingsSchema.fieldCount);
+		EXPECT(settings.width == 800);
+		EXPECT(settings.fullscreen == false);
+	},
+	CASE("Test: Generate from struct")
+	{
+		Settings settings;
+		settingsSchema.defaults(settings);
+		settings.scale = 0.75;
+		settings.fullscreen = true;
+		settings.title = "  a=b  ";
+		// same data through INIGenerator
+		mINI::INIStructure ini;
+		ini["window"].set({
+			{"width", "800"},
+			{"height", "600"},
+			{"scale", "0.75"},
+			{"fullscreen", "true"},
+			{"title", "a=b"}
+		});
+		ini["random"]["seed"] = "42";
+		for (const bool pretty : { false, true })
+		{
+			mINI::INIFile file("schema03.ini");
+			EXPECT(file.generate(ini, pretty));
+			EXPECT(settingsSchema.generate("schema04.ini", settings, pretty));
+			EXPECT(readTestFile("schema03.ini") == readTestFile("schema04.ini"));
+		}
+	},
+	CASE("Test: Generate and read back")
+	{
+		struct Escaped
+		{
+			int a;
+			std::string b;
+		};
+		constexpr mINI::INISchema escapedSchema {
+			mINI::INIField("s", "a=1", &Escaped::a, 0),
+			mINI::INIField("t", "b", &Escaped::b, ""),
+		};
+		Escaped input { -7, "x = y" };
+		std::string output;
+		escapedSchema.render(input, output);
+		EXPECT(output == std::string("[s]") + mINI::INIStringUtil::endl + "a\\=1=-7" + mINI::INIStringUtil::endl + "[t]" + mINI::INIStringUtil::endl + "b=x = y");
+		EXPECT(escapedSchema.generate("schema05.ini", input));
+		Escaped result {};
+		auto report = escapedSchema.read("schema05.ini", result);
+		EXPECT(report.complete());
+		EXPECT(result.a == -7);
+		EXPECT(result.b == "x = y");
+	}
+};
+
+int main(int argc, char** argv)
+{
+	// run tests
+	if (int failures = lest::run(mINI_tests, argc, argv))
+	{
+		return failures;
+	}
+	return std::cout << std::endl << "All tests passed!" << std::endl, EXIT_SUCCESS;
+}
@@ -0,0 +1,100 @@
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <atomic>
+#include "lest.hpp"
+#include "mini/snapshot.h"
+
+mINI::INIStructure makeData(std::size_t generation)
+{
+	mINI::INIStructure ini;
+	const std::string value = std::to_string(generation);
+	ini["data"]["a"] = value;
+	ini["data"]["b"] = value;
+	return ini;
+}
+
+const lest::test mINI_tests[] = {
+	CASE("Test: Publish and load")
+	{
+		mINI::INISnapshotStore store;
+		EXPECT(store.load()->size() == 0U);
+		store.publish(makeData(1));
+		auto snapshot = store.load();
+		EXPECT(snapshot->get("data").get("a") == "1");
+		store.publish(makeData(2));
+		EXPECT(snapshot->get("data").get("a") == "1");
+		EXPECT(store.load()->get("data").get("a") == "2");
+		EXPECT(store.read([](mINI::INIStructure const& ini) { return ini.get("data").get("b"); }) == "2");
+	},
+	CASE("Test: Old snapshots are released by their last reader")
+	{
+		mINI::INISnapshotStore store(makeData(1));
+		std::weak_ptr<const mINI::INIStructure> first = store.load();
+		auto held = store.load();
+		store.publish(makeData(2));
+		EXPECT(!first.expired());
+		held.reset();
+		EXPECT(first.expired());
+		std::weak_ptr<const mINI::INIStructure> second = store.load();
+		store.publish(makeData(3));
+		EXPECT(second.expired());
+	},
+	CASE("Test: Reload from file")
+	{
+		mINI::INIFile file("snapshot01.ini");
+		EXPECT(file.generate(makeData(7)));
+		mINI::INISnapshotStore store;
+		EXPECT(store.reload(file));
+		EXPECT(store.load()->get("data").get("b") == "7");
+		EXPECT(!store.reload(mINI::INIFile("snapshot_nonexistent.ini")));
+		EXPECT(store.load()->get("data").get("b") == "7");
+	},
+	CASE("Test: Concurrent readers see consistent snapshots")
+	{
+		const std::size_t publishCount = 2000;
+		mINI::INISnapshotStore store(makeData(0));
+		std::atomic<bool> done { false };
+		std::atomic<std::size_t> inconsistent { 0 };
+		std::vector<std::thread> readers;
+		for (int i = 0; i < 4; ++i)
+		{
+			readers.emplace_back([&]() {
+				std::size_t last = 0;
+				while (!done.load())
+				{
+					auto snapshot = store.load();
+					auto const& section = snapshot->get("data");
+					const std::size_t generation = std::stoul(section.get("a"));
+					if (section.get("b") != section.get("a") || generation < last)
+					{
+						++inconsistent;
+					}
+					last = generation;
+				}
+			});
+		}
+		for (std::size_t i = 1; i <= publishCount; ++i)
+		{
+			store.publish(makeData(i));
+		}
+		done = true;
+		for (auto& reader : readers)
+		{
+			reader.join();
+		}
+		EXPECT(inconsistent.load() == 0U);
+		EXPECT(store.load()->get("data").get("a") == std::to_string(publishCount));
+	}
+};
+
+int main(int argc, char** argv)
+{
+	// run tests
+	if (int failures = lest::run(mINI_tests, argc, argv))
+	{
+		return failures;
+	}
+	return std::cout << std::endl << "All tests passed!" << std::endl, EXIT_SUCCESS;
+}
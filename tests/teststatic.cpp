@@ -0,0 +1,80 @@
+#include <iostream>
+#include <string>
+#include <fstream>
+#include "lest.hpp"
+#include "mini/static.h"
+
+constexpr std::string_view defaultsText =
+	"; default settings\n"
+	"[Window]\n"
+	"width = 800\n"
+	"height=600\n"
+	"  title = mINI = test  \n"
+	"width = 1024\n"
+	"\n"
+	"[ escaped ] ; trailing comment\n"
+	"a\\=b = c\n"
+	"[empty]\r\n";
+
+constexpr mINI::INIStaticStructure<mINI::INIStatic::recordCount(defaultsText)> defaults(defaultsText);
+
+static_assert(defaults.valid());
+static_assert(defaults.has("window"));
+static_assert(defaults.has(" EMPTY "));
+static_assert(!defaults.has("missing"));
+static_assert(defaults.get("WINDOW").get("width") == "1024");
+static_assert(defaults.get("window").get("title") == "mINI = test");
+static_assert(defaults.get("escaped").get("a=b") == "c");
+static_assert(!defaults.get("escaped").has("a\\=b"));
+static_assert(!defaults.get("window").has("depth"));
+static_assert(defaults.get("missing").get("width").empty());
+
+constexpr std::string_view malformedText =
+	"orphan=1\n"
+	"[section]\n"
+	"key=value\n"
+	"garbage\n";
+
+constexpr mINI::INIStaticStructure<mINI::INIStatic::recordCount(malformedText)> malformed(malformedText);
+
+static_assert(!malformed.valid());
+static_assert(malformed.errorLine() == 1);
+static_assert(malformed.get("section").get("key") == "value");
+
+const lest::test mINI_tests[] = {
+	CASE("Test: Static structure matches read")
+	{
+		const std::string filename = "static01.ini";
+		{
+			std::ofstream fileWriteStream(filename, std::ios::out | std::ios::binary);
+			fileWriteStream << defaultsText;
+		}
+		mINI::INIFile file(filename);
+		mINI::INIStructure ini;
+		EXPECT(file.read(ini));
+		mINI::INIStructure copy;
+		defaults.copyTo(copy);
+		EXPECT(copy.size() == ini.size());
+		for (auto const& it : ini)
+		{
+			auto const& section = it.first;
+			EXPECT(defaults.has(section));
+			EXPECT(copy.get(section).size() == it.second.size());
+			for (auto const& it2 : it.second)
+			{
+				EXPECT(defaults.get(section).get(it2.first) == it2.second);
+				EXPECT(copy.get(section).get(it2.first) == it2.second);
+			}
+		}
+	}
+};
+
+int main(int argc, char** argv)
+{
+	// run tests
+	if (int failures = lest::run(mINI_tests, argc, argv))
+	{
+		return failures;
+	}
+	return std::cout << std::endl << "All tests passed!" << std::endl, EXIT_SUCCESS;
+}
@@ -0,0 +1,236 @@
+#include <iostream>
+#include <string>
+#include <sstream>
+#include <fstream>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include "lest.hpp"
+#include "mini/ini.h"
+
+const std::string filename = "data_stats.ini";
+
+const std::string contents =
+	"; settings\n"
+	"ignored = key\n"
+	"[window]\n"
+	"width = 800\n"
+	"height = 600\n"
+	"\n"
+	"not a key\n"
+	"[colors] ; trailing comment\n"
+	"; another comment\n"
+	"fg = white\n";
+
+//
+// allocation counting
+//
+std::atomic<std::uint64_t> allocationCount { 0 };
+
+void* operator new(std::size_t size)
+{
+	++allocationCount;
+	if (void* ptr = std::malloc(size != 0 ? size : 1))
+	{
+		return ptr;
+	}
+	throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+	std::free(ptr);
+}
+
+std::uint64_t countAllocations()
+{
+	return allocationCount.load();
+}
+
+//
+// helper functions
+//
+std::string readContents(std::string const& filename)
+{
+	std::ifstream fileReadStream(filename, std::ios::binary);
+	std::stringstream contents;
+	contents << fileReadStream.rdbuf();
+	return contents.str();
+}
+
+void writeContents(std::string const& filename, std::string const& contents)
+{
+	std::ofstream fileWriteStream(filename, std::ios::binary);
+	fileWriteStream << contents;
+}
+
+//
+// test cases
+//
+const lest::test mINI_tests[] = {
+	CASE("Test: Reading counts lines by kind")
+	{
+		mINI::INIStats stats;
+		mINI::INIStructure ini;
+		auto reader = mINI::INIReader::fromString(contents);
+		reader.stats = &stats;
+		EXPECT((reader >> ini));
+		EXPECT(stats.bytesRead == contents.size());
+		EXPECT(stats.lines == 11u);
+		EXPECT(stats.sections == 2u);
+		EXPECT(stats.keys == 4u);
+		EXPECT(stats.comments == 2u);
+		EXPECT(stats.unknownLines == 1u);
+		EXPECT_NOT(stats.isBOM);
+		EXPECT(stats.bytesWritten == 0u);
+		EXPECT(stats.format.count() == 0);
+		EXPECT(stats.flush.count() == 0);
+		EXPECT(ini.size() == 2u);
+	},
+	CASE("Test: Reading a file times I/O and counts the BOM")
+	{
+		writeContents(filename, "\xEF\xBB\xBF" + contents);
+		mINI::INIStats stats;
+		mINI::INIStructure ini;
+		mINI::INIReader reader(filename);
+		reader.stats = &stats;
+		EXPECT((reader >> ini));
+		EXPECT(stats.bytesRead == contents.size() + 3);
+		EXPECT(stats.isBOM);
+		EXPECT(stats.keys == 4u);
+		EXPECT(stats.io.count() > 0);
+		EXPECT(stats.split.count() > 0);
+		EXPECT(stats.total() == stats.io + stats.split + stats.parse + stats.insert);
+	},
+	CASE("Test: Reading without stats gives the same structure")
+	{
+		mINI::INIStats stats;
+		mINI::INIStructure ini1, ini2;
+		auto reader1 = mINI::INIReader::fromString(contents, true);
+		auto reader2 = mINI::INIReader::fromString(contents, true);
+		reader2.stats = &stats;
+		EXPECT((reader1 >> ini1));
+		EXPECT((reader2 >> ini2));
+		EXPECT(mINI::INIDiff(ini1, ini2).empty());
+		EXPECT(*reader1.getLines() == *reader2.getLines());
+	},
+	CASE("Test: Generating counts output")
+	{
+		mINI::INIStructure ini;
+		ini["a"]["x"] = "1";
+		ini["a"]["y"] = "2";
+		ini["b"]["z"] = "3";
+		ini["c"];
+		mINI::INIStats stats;
+		mINI::INIGenerator generator;
+		generator.prettyPrint = true;
+		generator.stats = &stats;
+		std::string output;
+		EXPECT(generator.generate(ini, output));
+		EXPECT(stats.sections == 3u);
+		EXPECT(stats.keys == 3u);
+		// two blank lines between the sections
+		EXPECT(stats.lines == 8u);
+		EXPECT(stats.bytesWritten == output.size());
+		EXPECT(stats.bytesRead == 0u);
+		EXPECT(stats.flush.count() == 0);
+		std::ostringstream stream;
+		EXPECT(generator.generate(ini, stream));
+		EXPECT(stats.sections == 6u);
+		EXPECT(stats.bytesWritten == output.size() * 2);
+	},
+	CASE("Test: Writing counts bytes read and written")
+	{
+		for (const bool atomicWrite : { false, true })
+		{
+			writeContents(filename, contents);
+			mINI::INIStructure ini;
+			mINI::INIFile(filename).read(ini);
+			ini["window"]["width"] = "1024";
+			ini["sound"]["volume"] = "7";
+			mINI::INIStats stats;
+			mINI::INIWriter writer(filename);
+			writer.atomicWrite = atomicWrite;
+			writer.stats = &stats;
+			EXPECT((writer << ini));
+			const std::string written = readContents(filename);
+			EXPECT(stats.bytesRead == contents.size());
+			EXPECT(stats.bytesWritten == written.size());
+			EXPECT(stats.sections == 2u);
+			EXPECT(stats.keys == 4u);
+			EXPECT(stats.format.count() > 0);
+			EXPECT(stats.flush.count() > 0);
+		}
+	},
+	CASE("Test: Counters add up until reset")
+	{
+		mINI::INIStats stats;
+		stats.allocationCounter = countAllocations;
+		for (int i = 0; i < 2; ++i)
+		{
+			mINI::INIStructure ini;
+			auto reader = mINI::INIReader::fromString(contents);
+			reader.stats = &stats;
+			reader >> ini;
+		}
+		EXPECT(stats.keys == 8u);
+		EXPECT(stats.bytesRead == contents.size() * 2);
+		stats.reset();
+		EXPECT(stats.keys == 0u);
+		EXPECT(stats.bytesRead == 0u);
+		EXPECT(stats.total().count() == 0);
+		EXPECT(stats.allocationCounter == &countAllocations);
+	},
+	CASE("Test: Allocations are counted with a counter")
+	{
+		mINI::INIStructure ini;
+		mINI::INIStats stats;
+		auto reader = mINI::INIReader::fromString(contents);
+		reader.stats = &stats;
+		reader >> ini;
+		EXPECT(stats.allocations == 0u);
+		stats.reset();
+		stats.allocationCounter = countAllocations;
+		ini.clear();
+		const auto before = countAllocations();
+		auto reader2 = mINI::INIReader::fromString(contents);
+		reader2.stats = &stats;
+		reader2 >> ini;
+		const auto after = countAllocations();
+		EXPECT(stats.allocations > 0u);
+		EXPECT(stats.allocations <= after - before);
+	},
+	CASE("Test: INIFile passes stats on")
+	{
+		writeContents(filename, contents);
+		mINI::INIStats stats;
+		mINI::INIFile file(filename);
+		file.stats = &stats;
+		mINI::INIStructure ini;
+		EXPECT(file.read(ini));
+		EXPECT(stats.keys == 4u);
+		ini["window"]["width"] = "1280";
+		EXPECT(file.write(ini));
+		EXPECT(stats.bytesWritten == readContents(filename).size());
+		stats.reset();
+		EXPECT(file.generate(ini));
+		EXPECT(stats.sections == 2u);
+		EXPECT(stats.bytesWritten == readContents(filename).size());
+		EXPECT(stats.flush.count() > 0);
+	}
+};
+
+int main(int argc, char** argv)
+{
+	// run tests
+	if (int failures = lest::run(mINI_tests, argc, argv))
+	{
+		return failures;
+	}
+	return std::cout << std::endl << "All tests passed!" << std::endl, EXIT_SUCCESS;
+}
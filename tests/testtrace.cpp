@@ -0,0 +1,234 @@
+#include <iostream>
+#include <string>
+#include <sstream>
+#include <fstream>
+#include <thread>
+#include <vector>
+#include "lest.hpp"
+#include "mini/trace.h"
+
+const std::string filename = "data_trace.ini";
+const std::string traceFilename = "data_trace.json";
+
+const std::string contents =
+	"; settings\n"
+	"[window]\n"
+	"width = 800\n"
+	"height = 600\n";
+
+//
+// helper functions
+//
+std::string readContents(std::string const& filename)
+{
+	std::ifstream fileReadStream(filename, std::ios::binary);
+	std::stringstream contents;
+	contents << fileReadStream.rdbuf();
+	return contents.str();
+}
+
+void writeContents(std::string const& filename, std::string const& contents)
+{
+	std::ofstream fileWriteStream(filename, std::ios::binary);
+	fileWriteStream << contents;
+}
+
+std::size_t countOccurences(std::string const& str, std::string const& what)
+{
+	std::size_t count = 0;
+	for (std::size_t pos = str.find(what); pos != std::string::npos; pos = str.find(what, pos + 1))
+	{
+		++count;
+	}
+	return count;
+}
+
+// records spans as "name" on begin and "/name:size" on end
+class RecordingSink : public mINI::INITraceSink
+{
+public:
+	std::vector<std::string> spans;
+
+	RecordingSink() { mINI::INITrace::setSink(this); }
+	~RecordingSink() override { mINI::INITrace::setSink(nullptr); }
+
+	void begin(const char* name) override
+	{
+		spans.emplace_back(name);
+	}
+	void end(const char* name, std::size_t size) override
+	{
+		spans.emplace_back("/" + std::string(name) + ":" + std::to_string(size));
+	}
+};
+
+//
+// test cases
+//
+const lest::test mINI_tests[] = {
+	CASE("Test: Reading emits nested spans with sizes")
+	{
+		writeContents(filename, contents);
+		RecordingSink sink;
+		mINI::INIStructure ini;
+		mINI::INIReader reader(filename);
+		EXPECT((reader >> ini));
+		const std::vector<std::string> expected = {
+			"INIReader::read",
+			"io", "/io:" + std::to_string(contents.size()),
+			"split", "/split:" + std::to_string(contents.size()),
+			"parse", "/parse:5",
+			"/INIReader::read:0"
+		};
+		EXPECT(sink.spans == expected);
+	},
+	CASE("Test: Writing emits format and flush spans")
+	{
+		writeContents(filename, contents);
+		mINI::INIFile file(filename);
+		mINI::INIStructure ini;
+		file.read(ini);
+		ini["window"]["width"] = "1024";
+		RecordingSink sink;
+		EXPECT(file.write(ini));
+		const std::string written = readContents(filename);
+		EXPECT(sink.spans.front() == "INIFile::write");
+		EXPECT(sink.spans.back() == "/INIFile::write:0");
+		const auto has = [&](std::string const& span) {
+			return std::find(sink.spans.begin(), sink.spans.end(), span) != sink.spans.end();
+		};
+		EXPECT(has("/format:" + std::to_string(written.size())));
+		EXPECT(has("/flush:" + std::to_string(written.size())));
+	},
+	CASE("Test: Removing from a map emits a reindex span")
+	{
+		mINI::INIMap<std::string> map;
+		for (int i = 0; i < 8; ++i)
+		{
+			map[std::to_string(i)] = "value";
+		}
+		RecordingSink sink;
+		map.remove("2");
+		map.remove("missing");
+		const std::vector<std::string> expected = { "reindex", "/reindex:5" };
+		EXPECT(sink.spans == expected);
+		EXPECT(map.size() == 7u);
+	},
+	CASE("Test: Nothing is emitted without a sink")
+	{
+		writeContents(filename, contents);
+		mINI::INIStructure ini;
+		{
+			RecordingSink sink;
+		}
+		EXPECT(mINI::INITrace::currentSink().load() == nullptr);
+		mINI::INIFile file(filename);
+		EXPECT(file.read(ini));
+		EXPECT(ini.get("window").get("width") == "800");
+	},
+	CASE("Test: Chrome traces are written as JSON")
+	{
+		writeContents(filename, contents);
+		{
+			mINI::INIChromeTrace trace(traceFilename);
+			mINI::INIStructure ini;
+			mINI::INIFile(filename).read(ini);
+			bool generateSuccess = false;
+			std::thread([&ini, &generateSuccess]() {
+				generateSuccess = mINI::INIFile(filename).generate(ini, true);
+			}).join();
+			EXPECT(generateSuccess);
+			EXPECT(trace.size() > 0u);
+		}
+		EXPECT(mINI::INITrace::currentSink().load() == nullptr);
+		const std::string json = readContents(traceFilename);
+		EXPECT(json.rfind("{\"traceEvents\":[", 0) == 0u);
+		EXPECT(json.find("],\"displayTimeUnit\":\"ns\"}") != std::string::npos);
+		EXPECT(countOccurences(json, "\"ph\":\"B\"") == countOccurences(json, "\"ph\":\"E\""));
+		EXPECT(json.find("{\"name\":\"INIFile::read\",\"cat\":\"mINI\",\"ph\":\"B\",\"ts\":") != std::string::npos);
+		EXPECT(json.find("\"tid\":0") != std::string::npos);
+		EXPECT(json.find("\"tid\":1") != std::string::npos);
+		EXPECT(json.find("\"args\":{\"size\":" + std::to_string(contents.size()) + "}") != std::string::npos);
+	},
+	CASE("Test: Flushing writes the events so far")
+	{
+		mINI::INIChromeTrace trace(traceFilename);
+		EXPECT(trace.flush());
+		EXPECT(countOccurences(readContents(traceFilename), "\"ph\"") == 0u);
+		mINI::INIStructure ini;
+		ini["a"]["b"] = "c";
+		std::string output;
+		mINI::INIGenerator().generate(ini, output);
+		EXPECT(trace.flush());
+		EXPECT(countOccurences(readContents(traceFilename), "\"ph\"") == 2u);
+	},
+	CASE("Test: Each thread keeps its own events")
+	{
+		const std::size_t threadCount = 4;
+		const std::size_t generateCount = 1000;
+		std::string json;
+		for (int round = 0; round < 2; ++round)
+		{
+			// the second trace must not reuse buffers of the first one
+			mINI::INIChromeTrace trace(traceFilename);
+			std::vector<std::thread> threads;
+			for (std::size_t t = 0; t < threadCount; ++t)
+			{
+				threads.emplace_back([&]() {
+					mINI::INIStructure ini;
+					ini["a"]["b"] = "c";
+					std::string output;
+					for (std::size_t i = 0; i < generateCount; ++i)
+					{
+						output.clear();
+						mINI::INIGenerator().generate(ini, output);
+					}
+				});
+			}
+			for (auto& thread : threads)
+			{
+				thread.join();
+			}
+			EXPECT(trace.size() == threadCount * generateCount * 2);
+			EXPECT(trace.flush());
+			json = readContents(traceFilename);
+		}
+		EXPECT(countOccurences(json, "\"ph\"") == threadCount * generateCount * 2);
+		// every thread has its own tid, and its spans begin and end in order
+		std::vector<std::size_t> open(threadCount, 0);
+		std::vector<std::size_t> ended(threadCount, 0);
+		bool nested = true;
+		for (std::size_t pos = json.find("\"ph\":\""); pos != std::string::npos; pos = json.find("\"ph\":\"", pos + 1))
+		{
+			const char phase = json[pos + 6];
+			const std::size_t tid = std::stoul(json.substr(json.find("\"tid\":", pos) + 6));
+			EXPECT(tid < threadCount);
+			if (phase == 'B')
+			{
+				nested = nested && open[tid] == 0;
+				++open[tid];
+			}
+			else
+			{
+				nested = nested && open[tid] == 1;
+				--open[tid];
+				++ended[tid];
+			}
+		}
+		EXPECT(nested);
+		for (std::size_t t = 0; t < threadCount; ++t)
+		{
+			EXPECT(ended[t] == generateCount);
+		}
+	}
+};
+
+int main(int argc, char** argv)
+{
+	// run tests
+	if (int failures = lest::run(mINI_tests, argc, argv))
+	{
+		return failures;
+	}
+	return std::cout << std::endl << "All tests passed!" << std::endl, EXIT_SUCCESS;
+}
@@ -0,0 +1,185 @@
+#include <iostream>
+#include <string>
+#include <fstream>
+#include <condition_variable>
+#include "lest.hpp"
+#include "mini/watch.h"
+
+#ifdef __linux__
+
+using namespace std::chrono_literals;
+
+class Collector
+{
+private:
+	std::mutex mutex;
+	std::condition_variable updated;
+	std::size_t count = 0;
+	std::shared_ptr<mINI::INIStructure> last;
+
+public:
+	void operator()(std::filesystem::path const&, mINI::INIStructure const& ini)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		++count;
+		last = std::make_shared<mINI::INIStructure>(ini);
+		updated.notify_all();
+	}
+	bool waitFor(std::size_t expected, std::chrono::milliseconds timeout = 5000ms)
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		return updated.wait_for(lock, timeout, [&]() { return count >= expected; });
+	}
+	std::size_t updates()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		return count;
+	}
+	std::string get(std::string const& section, std::string const& key)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		return (last) ? last->get(section).get(key) : std::string();
+	}
+};
+
+void writeFile(std::string const& filename, std::string const& contents)
+{
+	std::ofstream fileWriteStream(filename, std::ios::out | std::ios::binary);
+	fileWriteStream << contents;
+}
+
+const lest::test mINI_tests[] = {
+	CASE("Test: Reload on write")
+	{
+		const std::string filename = "watch01.ini";
+		writeFile(filename, "[a]\nkey=1\n");
+		Collector collector;
+		mINI::INIWatcher watcher(20ms);
+		EXPECT(watcher.watch(filename, std::ref(collector)));
+		writeFile(filename, "[a]\nkey=2\n");
+		EXPECT(collector.waitFor(1));
+		EXPECT(collector.get("a", "key") == "2");
+		// same contents, no reload
+		writeFile(filename, "[a]\nkey=2\n");
+		std::this_thread::sleep_for(200ms);
+		EXPECT(collector.updates() == 1U);
+	},
+	CASE("Test: Reload on atomic replace")
+	{
+		const std::string filename = "watch02.ini";
+		writeFile(filename, "[a]\nkey=1\n");
+		Collector collector;
+		mINI::INIWatcher watcher(20ms);
+		EXPECT(watcher.watch(filename, std::ref(collector)));
+		writeFile("watch02.ini.tmp", "[a]\nkey=replaced\n");
+		std::filesystem::rename("watch02.ini.tmp", filename);
+		EXPECT(collector.waitFor(1));
+		EXPECT(collector.get("a", "key") == "replaced");
+	},
+	CASE("Test: Bursts of writes are debounced")
+	{
+		const std::string filename = "watch03.ini";
+		writeFile(filename, "[a]\nkey=0\n");
+		Collector collector;
+		mINI::INIWatcher watcher(200ms);
+		EXPECT(watcher.watch(filename, std::ref(collector)));
+		for (int i = 1; i <= 20; ++i)
+		{
+			writeFile(filename, "[a]\nkey=" + std::to_string(i) + "\n");
+		}
+		EXPECT(collector.waitFor(1));
+		std::this_thread::sleep_for(400ms);
+		EXPECT(collector.updates() == 1U);
+		EXPECT(collector.get("a", "key") == "20");
+	},
+	CASE("Test: Files are read again after the event queue overflows")
+	{
+		const std::string filename = "watch05.ini";
+		writeFile(filename, "[a]\nkey=1\n");
+		std::mutex blockMutex;
+		std::unique_lock<std::mutex> block(blockMutex);
+		Collector collector;
+		mINI::INIWatcher watcher(20ms);
+		EXPECT(watcher.watch(filename, [&](std::filesystem::path const& path, mINI::INIStructure const& ini) {
+			collector(path, ini);
+			// hold the watcher thread until the queue is full
+			std::lock_guard<std::mutex> lock(blockMutex);
+		}));
+		writeFile(filename, "[a]\nkey=2\n");
+		EXPECT(collector.waitFor(1));
+		// alternating names keep the kernel from merging the events
+		for (int i = 0; i < 20000; ++i)
+		{
+			writeFile((i % 2 == 0) ? "watch05a.tmp" : "watch05b.tmp", "x");
+		}
+		writeFile(filename, "[a]\nkey=3\n");
+		block.unlock();
+		EXPECT(collector.waitFor(2));
+		EXPECT(collector.get("a", "key") == "3");
+		std::filesystem::remove("watch05a.tmp");
+		std::filesystem::remove("watch05b.tmp");
+	},
+	CASE("Test: Directories that are removed are watched again")
+	{
+		const std::filesystem::path directory = "watch06";
+		const auto filename = directory / "settings.ini";
+		std::filesystem::remove_all(directory);
+		std::filesystem::create_directory(directory);
+		writeFile(filename.string(), "[a]\nkey=1\n");
+		Collector collector;
+		mINI::INIWatcher watcher(20ms, 20ms);
+		EXPECT(watcher.watch(filename, std::ref(collector)));
+		std::filesystem::remove_all(directory);
+		std::this_thread::sleep_for(100ms);
+		std::filesystem::create_directory(directory);
+		writeFile(filename.string(), "[a]\nkey=2\n");
+		EXPECT(collector.waitFor(1));
+		EXPECT(collector.get("a", "key") == "2");
+		// and the new directory is watched as well
+		writeFile(filename.string(), "[a]\nkey=3\n");
+		EXPECT(collector.waitFor(2));
+		EXPECT(collector.get("a", "key") == "3");
+		// a directory moved away is replaced by the one now at its path
+		std::filesystem::remove_all("watch06.old");
+		std::filesystem::rename(directory, "watch06.old");
+		std::filesystem::create_directory(directory);
+		writeFile(filename.string(), "[a]\nkey=4\n");
+		EXPECT(collector.waitFor(3));
+		EXPECT(collector.get("a", "key") == "4");
+		std::filesystem::remove_all(directory);
+		std::filesystem::remove_all("watch06.old");
+	},
+	CASE("Test: No callbacks after stop")
+	{
+		const std::string filename = "watch04.ini";
+		writeFile(filename, "[a]\nkey=1\n");
+		Collector collector;
+		mINI::INIWatcher watcher(20ms);
+		EXPECT(watcher.watch(filename, std::ref(collector)));
+		watcher.stop();
+		writeFile(filename, "[a]\nkey=2\n");
+		std::this_thread::sleep_for(100ms);
+		EXPECT(collector.updates() == 0U);
+		EXPECT(!watcher.watch(filename, std::ref(collector)));
+	}
+};
+
+#else
+
+const lest::test mINI_tests[] = {
+	CASE("Test: File watcher is not available on this platform")
+	{
+	}
+};
+
+#endif
+
+int main(int argc, char** argv)
+{
+	// run tests
+	if (int failures = lest::run(mINI_tests, argc, argv))
+	{
+		return failures;
+	}
+	return std::cout << std::endl << "All tests passed!" << std::endl, EXIT_SUCCESS;
+}
@@ -3,6 +3,8 @@
 #include <vector>
 #include <tuple>
 #include <fstream>
+#include <thread>
+#include <atomic>
 #include "lest.hpp"
 #include "mini/ini.h"
 
@@ -457,6 +459,78 @@ const T_INIFileData testDataEmptyValues {
 	}
 };
 
+const T_INIFileData testDataUnchanged {
+	// filename
+	"data17.ini",
+	// original data
+	{
+		"[section]",
+		"GARBAGE",
+		"key=value",
+		"key=duplicate"
+	},
+	// expected result
+	{
+		"[section]",
+		"GARBAGE",
+		"key=value",
+		"key=duplicate"
+	}
+};
+
+const T_INIFileData testDataDirtySections {
+	// filename
+	"data18.ini",
+	// original data
+	{
+		"[clean]",
+		"key=value",
+		"[dirty]",
+		"key=value"
+	},
+	// expected result
+	{
+		"[clean]",
+		"key=value",
+		"[dirty]",
+		"key=changed",
+		"new=value"
+	}
+};
+
+const T_INIFileData testDataCachedLines {
+	// filename
+	"data19.ini",
+	// original data
+	{
+		"[section]",
+		"key=value"
+	},
+	// expected result
+	{
+		"[section]",
+		"key=changed"
+	}
+};
+
+const T_INIFileData testDataAtomic {
+	// filename
+	"data20.ini",
+	// original data
+	{
+		"; comment",
+		"[section]",
+		"key = value"
+	},
+	// expected result
+	{
+		"; comment",
+		"[section]",
+		"key = changed",
+		"new=value"
+	}
+};
+
 //
 // test cases
 //
@@ -716,6 +790,314 @@ const lest::test mINI_tests[] = {
 		EXPECT(file.write(ini) == true);
 		// verify data
 		EXPECT(verifyData(testDataEmptyValues));
+	},
+	CASE("Test: Unchanged structure is not rewritten")
+	{
+		auto const& filename = std::get<0>(testDataUnchanged);
+		// read from file
+		mINI::INIFile file(filename);
+		file.skipUnchanged = true;
+		mINI::INIStructure ini;
+		EXPECT(file.read(ini) == true);
+		auto const generation = ini.generation();
+		EXPECT(ini.get("section").get("key") == "duplicate");
+		EXPECT(ini.has("other") == false);
+		EXPECT(ini.generation() == generation);
+		// nothing changed, so the file is left as it is
+		EXPECT(file.write(ini) == true);
+		EXPECT(verifyData(testDataUnchanged));
+		// the file changed on disk, so it is updated to match the structure
+		{
+			std::ofstream fileWriteStream(filename, std::ios::app);
+			fileWriteStream << std::endl << "other=value";
+		}
+		EXPECT(file.write(ini) == true);
+		mINI::INIStructure written;
+		EXPECT(file.read(written) == true);
+		EXPECT(written["section"].has("other") == false);
+		// a copy is a different structure and is always written
+		mINI::INIStructure copy(ini);
+		EXPECT(copy.generation() > generation);
+	},
+	CASE("Test: Values assigned through references are written")
+	{
+		const std::string filename = "data_references.ini";
+		{
+			std::ofstream fileWriteStream(filename, std::ios::binary);
+			fileWriteStream << "[section]" << std::endl << "key=1";
+		}
+		mINI::INIFile file(filename);
+		mINI::INIStructure ini;
+		EXPECT(file.read(ini) == true);
+		// the reference is taken before the first write, so the second
+		// assignment doesn't change the structure's generation
+		auto& value = ini["section"]["key"];
+		value = "2";
+		EXPECT(file.write(ini) == true);
+		value = "3";
+		EXPECT(file.write(ini) == true);
+		mINI::INIStructure written;
+		EXPECT(mINI::INIFile(filename).read(written) == true);
+		EXPECT(written.get("section").get("key") == "3");
+		std::remove(filename.c_str());
+	},
+	CASE("Test: Dirty sections")
+	{
+		auto const& filename = std::get<0>(testDataDirtySections);
+		// read from file
+		mINI::INIFile file(filename);
+		mINI::INIStructure ini;
+		EXPECT(file.read(ini) == true);
+		// changes are only stamped while a tracker is started
+		auto generation = ini.generation();
+		ini["dirty"]["key"];
+		mINI::INIStructure copy(ini);
+		EXPECT(ini.generation() == generation);
+		EXPECT(copy.generation() == generation);
+		mINI::INIGenerationTracker tracker;
+		tracker.start();
+		ini["dirty"]["new"] = "value";
+		EXPECT(ini.generation() > generation);
+		EXPECT(file.write(ini) == true);
+		// change a key after a write
+		generation = ini.generation();
+		ini["dirty"].set("key", "changed");
+		EXPECT(ini.generation() > generation);
+		EXPECT(file.write(ini) == true);
+		EXPECT(file.write(ini) == true);
+		EXPECT(verifyData(testDataDirtySections));
+		// removals and clearing count as changes
+		generation = ini.generation();
+		ini["dirty"].remove("new");
+		EXPECT(ini.generation() > generation);
+		generation = ini.generation();
+		ini.remove("clean");
+		EXPECT(ini.generation() > generation);
+		generation = ini.generation();
+		ini.clear();
+		EXPECT(ini.generation() > generation);
+	},
+	CASE("Test: Write without reading the file again")
+	{
+		auto const& filename = std::get<0>(testDataCachedLines);
+		// read from file, keeping the lines
+		mINI::INIFile file(filename);
+		file.cacheContents = true;
+		mINI::INIStructure ini;
+		EXPECT(file.read(ini) == true);
+		// change the file behind the reader's back, keeping size and time
+		auto const time = std::filesystem::last_write_time(filename);
+		{
+			std::ofstream fileWriteStream(filename, std::ios::binary);
+			fileWriteStream << "[section]" << std::endl << ";ey=value";
+		}
+		std::filesystem::last_write_time(filename, time);
+		// the lines kept from read() are used instead of the file
+		ini["section"]["key"] = "changed";
+		EXPECT(file.write(ini) == true);
+		EXPECT(verifyData(testDataCachedLines));
+		// and the written contents are used by the next write
+		ini["section"]["key"] = "changed";
+		EXPECT(file.write(ini) == true);
+		EXPECT(verifyData(testDataCachedLines));
+	},
+	CASE("Test: Write reads the file again by default")
+	{
+		const std::string filename = "data_reread.ini";
+		{
+			std::ofstream fileWriteStream(filename, std::ios::binary);
+			fileWriteStream << "[section]\nkey=value";
+		}
+		mINI::INIFile file(filename);
+		mINI::INIStructure ini;
+		EXPECT(file.read(ini) == true);
+		// same size and time, so only the contents tell the change apart
+		auto const time = std::filesystem::last_write_time(filename);
+		{
+			std::ofstream fileWriteStream(filename, std::ios::binary);
+			fileWriteStream << "[section]\n;ey=value";
+		}
+		std::filesystem::last_write_time(filename, time);
+		ini["section"]["key"] = "changed";
+		EXPECT(file.write(ini) == true);
+		std::ifstream fileReadStream(filename, std::ios::binary);
+		std::string contents((std::istreambuf_iterator<char>(fileReadStream)), std::istreambuf_iterator<char>());
+		EXPECT(contents == "[section]\nkey=changed\n;ey=value");
+		// nothing is kept without an option that needs it, so changes
+		// aren't tracked either
+		auto const generation = ini.generation();
+		ini["section"]["other"] = "value";
+		EXPECT(ini.generation() == generation);
+		file.skipUnchanged = true;
+		EXPECT(file.read(ini) == true);
+		ini["section"]["other"] = "value";
+		EXPECT(ini.generation() > generation);
+		file.skipUnchanged = false;
+		EXPECT(file.write(ini) == true);
+		ini["section"]["another"] = "value";
+		auto const untracked = ini.generation();
+		ini["section"]["another"] = "value";
+		EXPECT(ini.generation() == untracked);
+	},
+	CASE("Test: Files can be shared between threads")
+	{
+		const std::string filename = "data_shared.ini";
+		{
+			std::ofstream fileWriteStream(filename, std::ios::binary);
+			fileWriteStream << "[section]\nkey=value";
+		}
+		mINI::INIFile file(filename);
+		file.cacheContents = true;
+		mINI::INIFile const& shared = file;
+		std::vector<std::thread> threads;
+		std::atomic<int> failures { 0 };
+		for (int i = 0; i < 4; ++i)
+		{
+			threads.emplace_back([&shared, &failures, i]() {
+				for (int j = 0; j < 50; ++j)
+				{
+					mINI::INIStructure ini;
+					if (!shared.read(ini))
+					{
+						++failures;
+					}
+					ini["thread" + std::to_string(i)]["count"] = std::to_string(j);
+					if (!shared.write(ini))
+					{
+						++failures;
+					}
+				}
+			});
+		}
+		for (auto& thread : threads)
+		{
+			thread.join();
+		}
+		EXPECT(failures == 0);
+		mINI::INIStructure ini;
+		EXPECT(file.read(ini) == true);
+		EXPECT(ini.get("section").get("key") == "value");
+		EXPECT(ini.size() > 1u);
+	},
+	CASE("Test: Atomic write")
+	{
+		namespace fs = std::filesystem;
+		auto const& filename = std::get<0>(testDataAtomic);
+		fs::permissions(filename, fs::perms::owner_read | fs::perms::owner_write);
+		// a file that happens to have the name of a temporary file is left alone
+		{
+			std::ofstream fileWriteStream(filename + ".tmp", std::ios::binary);
+			fileWriteStream << "user data";
+		}
+		const auto countTempFiles = [&filename]() {
+			std::size_t count = 0;
+			for (auto const& entry : fs::directory_iterator("."))
+			{
+				if (entry.path().filename().string().rfind(filename + ".tmp.", 0) == 0)
+				{
+					++count;
+				}
+			}
+			return count;
+		};
+		mINI::INIFile file(filename);
+		file.atomicWrite = true;
+		mINI::INIStructure ini;
+		EXPECT(file.read(ini) == true);
+		ini["section"]["key"] = "changed";
+		ini["section"]["new"] = "value";
+		EXPECT(file.write(ini) == true);
+		EXPECT(verifyData(testDataAtomic));
+		EXPECT(fs::status(filename).permissions() == (fs::perms::owner_read | fs::perms::owner_write));
+		EXPECT(countTempFiles() == 0u);
+		{
+			std::ifstream fileReadStream(filename + ".tmp", std::ios::binary);
+			std::string userData;
+			std::getline(fileReadStream, userData);
+			EXPECT(userData == "user data");
+		}
+		// the writer keeps the BOM
+		{
+			std::ofstream fileWriteStream(filename, std::ios::binary);
+			fileWriteStream << "\xEF\xBB\xBF[section]\nkey=value\n";
+		}
+		mINI::INIWriter writer(filename);
+		writer.atomicWrite = true;
+		EXPECT((writer << ini) == true);
+		mINI::INIStructure ini2;
+		EXPECT(mINI::INIFile(filename).read(ini2) == true);
+		EXPECT(ini2.get("section").get("new") == "value");
+		std::ifstream fileReadStream(filename, std::ios::binary);
+		std::string bom(3, ' ');
+		fileReadStream.read(bom.data(), 3);
+		EXPECT(bom == "\xEF\xBB\xBF");
+		// and creates missing files
+		fs::remove(filename);
+		EXPECT((writer << ini) == true);
+		EXPECT(mINI::INIFile(filename).read(ini2) == true);
+		EXPECT(ini2.get("section").get("key") == "changed");
+	},
+	CASE("Test: Atomic writes follow symlinks and keep the owner")
+	{
+#if defined(__unix__) || defined(__APPLE__)
+		namespace fs = std::filesystem;
+		const std::string target = "data_atomic_target.ini";
+		const std::string link = "data_atomic_link.ini";
+		{
+			std::ofstream fileWriteStream(target, std::ios::binary);
+			fileWriteStream << "[section]\nkey=value\n";
+		}
+		fs::remove(link);
+		fs::create_symlink(target, link);
+		// giving a file away takes privileges the tests may not have
+		const bool chowned = (::chown(target.c_str(), 12345, 12345) == 0);
+		mINI::INIFile file(link);
+		file.atomicWrite = true;
+		mINI::INIStructure ini;
+		EXPECT(file.read(ini) == true);
+		ini["section"]["key"] = "changed";
+		EXPECT(file.write(ini) == true);
+		EXPECT(fs::is_symlink(link));
+		mINI::INIStructure written;
+		EXPECT(mINI::INIFile(target).read(written) == true);
+		EXPECT(written.get("section").get("key") == "changed");
+		ini["section"]["key"] = "generated";
+		EXPECT(file.generate(ini) == true);
+		EXPECT(fs::is_symlink(link));
+		EXPECT(mINI::INIFile(target).read(written) == true);
+		EXPECT(written.get("section").get("key") == "generated");
+		if (chowned)
+		{
+			struct stat fileStat;
+			EXPECT(::stat(target.c_str(), &fileStat) == 0);
+			EXPECT(fileStat.st_uid == 12345u);
+			EXPECT(fileStat.st_gid == 12345u);
+		}
+		fs::remove(link);
+		fs::remove(target);
+#endif
+	},
+	CASE("Test: Write to a string")
+	{
+		std::string contents =
+			";some comment\n"
+			"[some section]\n"
+			"some key=1\n"
+			"other key=2";
+		mINI::INIStructure ini;
+		EXPECT((mINI::INIReader::fromString(contents) >> ini) == true);
+		ini["some section"]["some key"] = "2";
+		ini["some section"]["yet another key"] = "3";
+		mINI::INIWriter writer;
+		EXPECT(writer.update(contents, ini) == true);
+		std::string const endl = mINI::INIStringUtil::endl;
+		EXPECT(contents ==
+			";some comment" + endl +
+			"[some section]" + endl +
+			"some key=2" + endl +
+			"other key=2" + endl +
+			"yet another key=3"
+		);
 	}
 };
 
@@ -737,6 +1119,10 @@ int main(int argc, char** argv)
 	writeTestFile(testDataMalformed2);
 	writeTestFile(testDataConsecutiveWrites);
 	writeTestFile(testDataEmptyValues);
+	writeTestFile(testDataUnchanged);
+	writeTestFile(testDataDirtySections);
+	writeTestFile(testDataCachedLines);
+	writeTestFile(testDataAtomic);
 	
 	// run tests
 	if (int failures = lest::run(mINI_tests, argc, argv))
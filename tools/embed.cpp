@@ -0,0 +1,293 @@
+// Generates a C++ header with an mINI::INIEmbeddedStructure from an INI file.
+// Used by the mini_embed() CMake function.
+//
+//   embed <input.ini> <output.h> <name> [--case-sensitive]
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "mini/embed.h"
+
+namespace
+{
+	std::string literal(std::string_view str)
+	{
+		std::string result = "\"";
+		for (const char c : str)
+		{
+			const auto u = static_cast<unsigned char>(c);
+			if (c == '"' || c == '\\')
+			{
+				result += '\\';
+				result += c;
+			}
+			else if (u < 0x20 || u >= 0x7F || c == '?')
+			{
+				// octal escapes have a fixed length and cannot run into the next character
+				char buffer[8];
+				std::snprintf(buffer, sizeof(buffer), "\\%03o", u);
+				result += buffer;
+			}
+			else
+			{
+				result += c;
+			}
+		}
+		return result + "\"";
+	}
+
+	// hash and displace: entries are grouped into buckets by their hash, and
+	// every bucket gets the first displacement that moves all of its entries
+	// into free slots. Large buckets go first, while most slots are still free,
+	// so each bucket needs few attempts and the table has one slot per entry.
+	struct Index
+	{
+		std::vector<std::uint32_t> displacements;
+		std::vector<std::uint32_t> slots;
+	};
+
+	bool place(Index& index, std::vector<std::uint64_t> const& hashes)
+	{
+		const auto slotCount = static_cast<std::uint32_t>(std::max<std::size_t>(hashes.size(), 1));
+		const auto bucketCount = static_cast<std::uint32_t>(std::max<std::size_t>((hashes.size() + 1) / 2, 1));
+		index.displacements.assign(bucketCount, 0U);
+		index.slots.assign(slotCount, 0U);
+		std::vector<std::vector<std::uint32_t>> buckets(bucketCount);
+		for (std::size_t i = 0; i < hashes.size(); ++i)
+		{
+			buckets[mINI::INIEmbed::bucket(hashes[i], bucketCount)].push_back(static_cast<std::uint32_t>(i));
+		}
+		std::vector<std::uint32_t> order(bucketCount);
+		for (std::uint32_t i = 0; i < bucketCount; ++i)
+		{
+			order[i] = i;
+		}
+		std::stable_sort(order.begin(), order.end(), [&buckets](std::uint32_t a, std::uint32_t b) {
+			return buckets[a].size() > buckets[b].size();
+		});
+		// the last bucket placed has a single free slot and needs slotCount attempts on average
+		const std::uint64_t maxAttempts = std::max<std::uint64_t>(std::uint64_t(1) << 16, std::uint64_t(slotCount) * 32);
+		std::vector<std::uint32_t> placed;
+		for (const std::uint32_t b : order)
+		{
+			auto const& bucket = buckets[b];
+			for (std::size_t i = 0; i < bucket.size(); ++i)
+			{
+				for (std::size_t j = 0; j < i; ++j)
+				{
+					if (hashes[bucket[i]] == hashes[bucket[j]])
+					{
+						// no displacement separates equal hashes
+						return false;
+					}
+				}
+			}
+			std::uint64_t attempt = 0;
+			for (; attempt < maxAttempts; ++attempt)
+			{
+				const auto displacement = static_cast<std::uint32_t>(attempt);
+				placed.clear();
+				for (const std::uint32_t i : bucket)
+				{
+					const std::uint32_t slot = mINI::INIEmbed::slot(hashes[i], displacement, slotCount);
+					if (index.slots[slot] != 0U || std::find(placed.begin(), placed.end(), slot) != placed.end())
+					{
+						break;
+					}
+					placed.push_back(slot);
+				}
+				if (placed.size() == bucket.size())
+				{
+					break;
+				}
+			}
+			if (attempt == maxAttempts)
+			{
+				return false;
+			}
+			index.displacements[b] = static_cast<std::uint32_t>(attempt);
+			for (std::size_t i = 0; i < bucket.size(); ++i)
+			{
+				index.slots[placed[i]] = bucket[i] + 1U;
+			}
+		}
+		return true;
+	}
+
+	void writeTable(std::ofstream& out, const char* name, std::vector<std::uint32_t> const& table)
+	{
+		out << "\tinline constexpr std::uint32_t " << name << "[] = {";
+		for (std::size_t i = 0; i < table.size(); ++i)
+		{
+			out << ((i % 16 == 0) ? "\n\t\t" : " ") << table[i] << ",";
+		}
+		out << "\n\t};\n";
+	}
+}
+
+int main(int argc, char** argv)
+{
+	if (argc < 4)
+	{
+		std::cerr << "Use: " << argv[0] << " <input.ini> <output.h> <name> [--case-sensitive]" << std::endl;
+		return 1;
+	}
+	const std::string inputFile = argv[1];
+	const std::string outputFile = argv[2];
+	const std::string name = argv[3];
+	const bool caseSensitive = (argc > 4 && std::string(argv[4]) == "--case-sensitive");
+
+	// read and validate; sections and keys are merged the same way INIReader does
+	struct Section
+	{
+		std::string name;
+		std::vector<std::pair<std::string, std::string>> keys;
+		std::unordered_map<std::string, std::size_t> keyIndex;
+	};
+	std::vector<Section> sections;
+	std::unordered_map<std::string, std::size_t> sectionIndex;
+	std::size_t sectionCurrent = 0;
+	std::size_t lineNumber = 0;
+	bool inSection = false;
+	bool malformed = false;
+	auto normalize = [caseSensitive](std::string str) {
+		if (!caseSensitive)
+		{
+			for (char& c : str)
+			{
+				c = mINI::INIEmbed::foldCase(c, false);
+			}
+		}
+		return str;
+	};
+	mINI::INIReader reader(inputFile);
+	const bool readSuccess = reader.visit([&](std::string const& line, mINI::INIParser::PDataType parseResult, mINI::INIParser::T_ParseValues const& parseData) {
+		++lineNumber;
+		if (parseResult == mINI::INIParser::PDataType::PDATA_SECTION)
+		{
+			auto section = normalize(parseData.first);
+			auto it = sectionIndex.find(section);
+			if (it == sectionIndex.end())
+			{
+				it = sectionIndex.emplace(section, sections.size()).first;
+				sections.push_back({ section, {}, {} });
+			}
+			sectionCurrent = it->second;
+			inSection = true;
+		}
+		else if (parseResult == mINI::INIParser::PDataType::PDATA_KEYVALUE && inSection)
+		{
+			auto& section = sections[sectionCurrent];
+			auto key = normalize(parseData.first);
+			auto it = section.keyIndex.find(key);
+			if (it == section.keyIndex.end())
+			{
+				section.keyIndex.emplace(key, section.keys.size());
+				section.keys.emplace_back(key, parseData.second);
+			}
+			else
+			{
+				section.keys[it->second].second = parseData.second;
+			}
+		}
+		else if (parseResult == mINI::INIParser::PDataType::PDATA_KEYVALUE || parseResult == mINI::INIParser::PDataType::PDATA_UNKNOWN)
+		{
+			std::cerr << inputFile << ":" << lineNumber << ": error: "
+				<< ((parseResult == mINI::INIParser::PDataType::PDATA_UNKNOWN) ? "malformed line" : "key outside of a section")
+				<< ": " << line << std::endl;
+			malformed = true;
+		}
+	});
+	if (!readSuccess)
+	{
+		std::cerr << inputFile << ": error: cannot read file" << std::endl;
+		return 1;
+	}
+	if (malformed)
+	{
+		return 1;
+	}
+
+	// flatten keys and build an index for sections and one for keys; a seed
+	// is only changed in the unlikely case of two names with equal hashes
+	std::vector<std::uint32_t> firstKeys;
+	std::vector<std::pair<std::uint32_t, std::string const*>> keys;
+	for (std::size_t i = 0; i < sections.size(); ++i)
+	{
+		firstKeys.push_back(static_cast<std::uint32_t>(keys.size()));
+		for (auto const& it : sections[i].keys)
+		{
+			keys.emplace_back(static_cast<std::uint32_t>(i), &it.first);
+		}
+	}
+	Index sectionTable;
+	Index keyTable;
+	std::vector<std::uint64_t> sectionHashes(sections.size());
+	std::vector<std::uint64_t> keyHashes(keys.size());
+	std::uint32_t seed = 0;
+	for (;; ++seed)
+	{
+		for (std::size_t i = 0; i < sections.size(); ++i)
+		{
+			sectionHashes[i] = mINI::INIEmbed::hashName(seed, sections[i].name, caseSensitive);
+		}
+		for (std::size_t i = 0; i < keys.size(); ++i)
+		{
+			keyHashes[i] = mINI::INIEmbed::hashKey(seed, keys[i].first, *keys[i].second, caseSensitive);
+		}
+		if (place(sectionTable, sectionHashes) && place(keyTable, keyHashes))
+		{
+			break;
+		}
+	}
+
+	std::ofstream out(outputFile, std::ios::out | std::ios::binary);
+	if (!out.is_open())
+	{
+		std::cerr << outputFile << ": error: cannot write file" << std::endl;
+		return 1;
+	}
+	out << "// Generated by mini_embed() from " << inputFile << ". Do not edit.\n"
+		<< "#pragma once\n"
+		<< "#include \"mini/embed.h\"\n\n"
+		<< "namespace " << name << "\n{\n"
+		<< "\tinline constexpr mINI::INIEmbeddedSectionData sections[] = {\n";
+	for (std::size_t i = 0; i < sections.size(); ++i)
+	{
+		out << "\t\t{ " << literal(sections[i].name) << ", " << firstKeys[i] << ", " << sections[i].keys.size() << " },\n";
+	}
+	if (sections.empty())
+	{
+		out << "\t\t{ \"\", 0, 0 }\n";
+	}
+	out << "\t};\n"
+		<< "\tinline constexpr mINI::INIEmbeddedKey keys[] = {\n";
+	for (auto const& section : sections)
+	{
+		for (auto const& it : section.keys)
+		{
+			out << "\t\t{ " << literal(it.first) << ", " << literal(it.second) << " },\n";
+		}
+	}
+	if (keys.empty())
+	{
+		out << "\t\t{ \"\", \"\" }\n";
+	}
+	out << "\t};\n";
+	writeTable(out, "sectionDisplacements", sectionTable.displacements);
+	writeTable(out, "sectionSlots", sectionTable.slots);
+	writeTable(out, "keyDisplacements", keyTable.displacements);
+	writeTable(out, "keySlots", keyTable.slots);
+	out << "\tinline constexpr mINI::INIEmbeddedStructure ini({\n"
+		<< "\t\tsections, " << sections.size() << ", keys,\n"
+		<< "\t\t{ sectionDisplacements, " << sectionTable.displacements.size() << ", sectionSlots, " << sectionTable.slots.size() << " },\n"
+		<< "\t\t{ keyDisplacements, " << keyTable.displacements.size() << ", keySlots, " << keyTable.slots.size() << " },\n"
+		<< "\t\t" << seed << "U, " << ((caseSensitive) ? "true" : "false") << "\n"
+		<< "\t});\n"
+		<< "}\n";
+	return out.good() ? 0 : 1;
+}